@@ -0,0 +1,14 @@
+#version 330
+
+in vec2 fragCorner;
+in vec4 fragColor;
+flat in float fragShape;
+
+out vec4 finalColor;
+
+void main()
+{
+    // Shape 0 is a circle: cut the quad down to the inscribed disc
+    if ((fragShape < 0.5) && (dot(fragCorner, fragCorner) > 1.0)) discard;
+    finalColor = fragColor;
+}
@@ -0,0 +1,24 @@
+#version 330
+
+// Unit quad corner in [-1, 1]
+layout(location = 0) in vec2 vertexCorner;
+
+// Per-instance attributes
+layout(location = 1) in vec2 instanceCenter;
+layout(location = 2) in vec2 instanceExtent;
+layout(location = 3) in vec4 instanceColor;
+layout(location = 4) in float instanceShape;
+
+uniform mat4 mvp;
+
+out vec2 fragCorner;
+out vec4 fragColor;
+flat out float fragShape;
+
+void main()
+{
+    fragCorner = vertexCorner;
+    fragColor = instanceColor;
+    fragShape = instanceShape;
+    gl_Position = mvp*vec4(instanceCenter + vertexCorner*instanceExtent, 0.0, 1.0);
+}
@@ -0,0 +1,86 @@
+#version 430
+
+// One invocation per active entity, in grouped order (circles, then rectangles);
+// must match GpuSimulation::group_size
+layout(local_size_x = 256) in;
+
+struct Body {
+    vec2 position;
+    vec2 velocity;
+    // Position before the last tick, interpolated from for rendering
+    vec2 previous;
+    // Scaled half-extents (radius for circles)
+    vec2 extent;
+};
+
+// Same layout as ShapeInstance, read by the shape renderer as vertex attributes
+struct Instance {
+    vec2 center;
+    vec2 extent;
+    uint color;
+    float shape;
+};
+
+layout(std430, binding = 0) buffer Bodies { Body bodies[]; };
+layout(std430, binding = 1) readonly buffer Order { uint order[]; };
+layout(std430, binding = 2) readonly buffer Colors { uint colors[]; };
+layout(std430, binding = 3) writeonly buffer Instances { Instance instances[]; };
+
+uniform int activeCount;
+uniform int circleCount;
+// Ticks due this frame, each dt seconds long
+uniform int steps;
+uniform float dt;
+uniform vec2 world;
+// Velocity change per tick from gravity, and velocity scale per tick from damping
+uniform float gravity;
+uniform float damping;
+uniform int wrapEnabled;
+// Set when the simulation resumes, as previous positions are stale after a pause
+uniform int resetPrevious;
+uniform float alpha;
+uniform float pointSize;
+// Visible world area as (x, y, width, height)
+uniform vec4 view;
+
+void main()
+{
+    int k = int(gl_GlobalInvocationID.x);
+    if (k >= activeCount) return;
+    uint i = order[k];
+    Body body = bodies[i];
+    if (resetPrevious != 0) body.previous = body.position;
+
+    for (int s = 0; s < steps; ++s)
+    {
+        body.previous = body.position;
+        body.velocity *= damping;
+        body.velocity.y += gravity;
+        vec2 next = body.position + body.velocity*dt;
+        if (wrapEnabled != 0)
+        {
+            // Shapes wrap once their centre leaves the world
+            if (next.x < 0.0) next.x += world.x;
+            else if (next.x > world.x) next.x -= world.x;
+            if (next.y < 0.0) next.y += world.y;
+            else if (next.y > world.y) next.y -= world.y;
+            body.position = next;
+        }
+        else
+        {
+            // Bounce off the edges the shape's extents would cross
+            if (next.x - body.extent.x < 0.0 || next.x + body.extent.x > world.x) body.velocity.x = -body.velocity.x;
+            if (next.y - body.extent.y < 0.0 || next.y + body.extent.y > world.y) body.velocity.y = -body.velocity.y;
+            body.position += body.velocity*dt;
+        }
+    }
+    bodies[i] = body;
+
+    // Circles only a few pixels across are drawn as squares, as on the CPU path
+    bool isCircle = k < circleCount && body.extent.x >= pointSize*0.5;
+    // Shapes outside the view keep their slot, so the draw order stays the same,
+    // but are collapsed to a point that covers no pixels
+    vec2 center = mix(body.previous, body.position, alpha);
+    bool isVisible = all(lessThanEqual(view.xy, center + body.extent)) && all(lessThanEqual(center - body.extent, view.xy + view.zw));
+    instances[k] = Instance(center, isVisible ? body.extent : vec2(0.0), colors[i], isCircle ? 0.0 : 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330
+
+in vec2 fragTexCoord;
+
+uniform sampler2D texture0;
+uniform vec4 textColor;
+
+out vec4 finalColor;
+
+void main()
+{
+    // The atlas alpha is the signed distance to the glyph outline, 0.5 on the
+    // edge; smoothing over one screen pixel keeps edges sharp at any scale
+    float distance = texture(texture0, fragTexCoord).a - 0.5;
+    float width = length(vec2(dFdx(distance), dFdy(distance)));
+    float alpha = smoothstep(-width, width, distance);
+    finalColor = vec4(textColor.rgb, textColor.a*alpha);
+}
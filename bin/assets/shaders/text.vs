@@ -0,0 +1,18 @@
+#version 330
+
+// Unit quad corner in [0, 1]
+layout(location = 0) in vec2 vertexCorner;
+
+// Per-instance attributes
+layout(location = 1) in vec4 instanceRect;
+layout(location = 2) in vec4 instanceTexRect;
+
+uniform mat4 mvp;
+
+out vec2 fragTexCoord;
+
+void main()
+{
+    fragTexCoord = mix(instanceTexRect.xy, instanceTexRect.zw, vertexCorner);
+    gl_Position = mvp*vec4(instanceRect.xy + vertexCorner*instanceRect.zw, 0.0, 1.0);
+}
@@ -5,18 +5,67 @@
  * @date 2024-05-17
  */
 #include <include/raylib.h>
+#include <include/raymath.h>
+#include <include/rlgl.h>
 #include <imgui/imgui.h>
 #include <imgui/rlImGui.h>
 #include <imgui/imgui_stdlib.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cctype>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
-#include <memory>
+#include <mutex>
+#include <new>
+#include <numbers>
+#include <numeric>
+#include <random>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// raylib links GLFW, whose loader resolves the OpenGL 4.3 entry points rlgl is built without
+extern "C" void (*glfwGetProcAddress(const char* procname))(void);
+
+// Scoped frame profiler timers, compiled out unless A1_PROFILE is defined
+#if defined(A1_PROFILE)
+#define A1_PROFILE_SCOPE(profiler, phase) const auto profile_scope = a1::ProfileScope{ profiler, phase }
+#else
+#define A1_PROFILE_SCOPE(profiler, phase) static_cast<void>(0)
+#endif
+
+// Scoped heap allocation tags, compiled out unless A1_MEMORY is defined
+#if defined(A1_MEMORY)
+#define A1_MEMORY_SCOPE(tag) const auto memory_scope = a1::MemoryScope{ tag }
+#else
+#define A1_MEMORY_SCOPE(tag) static_cast<void>(0)
+#endif
 
 namespace a1 {
 	/**
@@ -28,6 +77,14 @@ namespace a1 {
 		int height = 800;
 	};
 
+	/**
+	 * Bounds of the simulated world, which may be larger than the window.
+	 */
+	struct World {
+		int width = 1280;
+		int height = 800;
+	};
+
 	/**
 	 * Floating point RGBA color.
 	 */
@@ -126,14 +183,36 @@ namespace a1 {
 	};
 
 	/**
-	 * Represents a 2-dimensional shape which can be drawn to the screen with raylib.
+	 * Kind of shape, used to tag shape parameters in flat storage.
+	 */
+	enum class ShapeType : std::uint8_t {
+		circle,
+		rectangle
+	};
+
+	/**
+	 * Number of ShapeType values.
+	 */
+	inline constexpr std::size_t shape_type_count = 2;
+
+	/**
+	 * Represents a circle which can be drawn to the screen with raylib.
 	 */
-	class Shape {
+	class Circle {
 	public:
+		float radius = 1.0f;
+
+		/**
+		 * Creates a default circle with radius 1.
+		 */
+		Circle() = default;
+
 		/**
-		 * Destructor
+		 * Creates a circle with the specified radius.
+		 * @param Radius
+		 * @warning The effect of creating a circle with negative radius is undefined.
 		 */
-		virtual ~Shape() = default;
+		Circle(float radius) : radius(radius) {}
 
 		/*
 		 * Measures an axis aligned bounding box for a given a position and scale.
@@ -141,690 +220,7627 @@ namespace a1 {
 		 * @param scale Scale factor
 		 * @return Axis aligned bounding box
 		 */
-		virtual AABB aabb(Position position, float scale) const = 0;
+		AABB aabb(Position position, float scale) const;
 
 		/**
-		 * Draws a shape with specified position, scale, and color.
+		 * Draws a circle with specified position, scale, and color.
 		 * @param position Coordinates in pixels
 		 * @param scale Scale factor
 		 * @param color Fill color
 		 */
-		virtual void draw(Position position, float scale, Color color) const = 0;
+		void draw(Position position, float scale, Color color) const;
 
 		/**
-		 * Creates a new copy of this shape polymorphically.
-		 * @return Owning pointer to new shape
+		 * Draws a circle with specified position, scale, color, and number of edge segments.
+		 * @param position Coordinates in pixels
+		 * @param scale Scale factor
+		 * @param color Fill color
+		 * @param segments Number of triangles in the fan, at least 4
 		 */
-		virtual Shape* clone() const = 0;
+		void draw(Position position, float scale, Color color, int segments) const;
 	};
 
 	/**
-	 * Represents a circle which can be drawn to the screen with raylib.
+	 * Represents a rectangle which can be drawn to the screen with raylib.
 	 */
-	class Circle : public Shape {
+	class Rectangle {
 	public:
-		float radius = 1.0f;
+		float width = 1.0f;
+		float height = 1.0f;
 
 		/**
-		 * Creates a default circle with radius 1.
+		 * Creates a default rectangle with width and height 1.
 		 */
-		Circle() = default;
+		Rectangle() = default;
 
 		/**
-		 * Creates a circle with the specified radius.
-		 * @param Radius
-		 * @warning The effect of creating a circle with negative radius is undefined.
+		 * Creates a rectangle with the specified width and height.
+		 * @param width Width
+		 * @param height Height
+		 * @warning The effect of creating a rectangle with negative width or height is undefined.
 		 */
-		Circle(float radius) : radius(radius) {}
+		Rectangle(float width, float height) : width(width), height(height) {}
+
+		/*
+		 * Measures an axis aligned bounding box for a given a position and scale.
+		 * @param position Coordinates in pixels
+		 * @param scale Scale factor
+		 * @return Axis aligned bounding box
+		 */
+		AABB aabb(Position position, float scale) const;
 
-		AABB aabb(Position position, float scale) const override;
-		Shape* clone() const override { return new Circle{ *this }; }
-		void draw(Position position, float scale, Color color) const override;
+		/**
+		 * Draws a rectangle with specified position, scale, and color.
+		 * @param position Coordinates in pixels
+		 * @param scale Scale factor
+		 * @param color Fill color
+		 */
+		void draw(Position position, float scale, Color color) const;
 	};
 
 	/**
-	 * Represents a rectangle which can be drawn to the screen with raylib.
+	 * Closed set of 2-dimensional shapes which can be drawn to the screen with raylib.
+	 */
+	using Shape = std::variant<Circle, Rectangle>;
+
+	/**
+	 * Reference to an entity stored in an entity store.
+	 */
+	struct EntityHandle {
+		std::uint32_t index = 0;
+		// Generation of the slot when the handle was taken, so a handle to a
+		// despawned entity is not mistaken for the entity reusing its slot
+		std::uint32_t generation = 0;
+
+		friend bool operator ==(EntityHandle left, EntityHandle right) = default;
+	};
+
+	/**
+	 * Half-open range [begin, end) of entity indices.
+	 */
+	struct IndexRange {
+		std::uint32_t begin = 0;
+		std::uint32_t end = 0;
+	};
+
+	/**
+	 * Index of a name in a name table.
+	 */
+	using NameId = std::uint32_t;
+
+	/**
+	 * Interned names stored contiguously in insertion order.
+	 * @details Every name lives NUL-terminated in one character arena, so a table
+	 *          of N names takes a constant number of allocations once reserved.
+	 *          Names are never freed one at a time, only in bulk by clear() and
+	 *          truncate(). Lookups use an open-addressing index into the arena.
 	 */
-	class Rectangle : public Shape {
+	class NameTable {
 	public:
-		float width = 1.0f;
-		float height = 1.0f;
+		static constexpr NameId no_name = std::numeric_limits<NameId>::max();
 
 		/**
-		 * Creates a default rectangle with width and height 1.
+		 * Gets the ID of a name, adding the name if it is not in the table.
+		 * @param name Name
+		 * @return Name ID
 		 */
-		Rectangle() = default;
+		NameId intern(std::string_view name);
 
 		/**
-		 * Creates a rectangle with the specified width and height.
-		 * @param width Width
-		 * @param height Height
-		 * @warning The effect of creating a rectangle with negative width or height is undefined.
+		 * Gets the ID of a name without adding it.
+		 * @param name Name
+		 * @return Name ID, or no_name if the name is not in the table
 		 */
-		Rectangle(float width, float height) : width(width), height(height) {}
+		NameId find(std::string_view name) const;
+
+		/**
+		 * Adds a name without looking for an existing copy.
+		 * @param name Name
+		 * @return Name ID
+		 */
+		NameId append(std::string_view name);
+
+		/**
+		 * Adds a name without looking for an existing copy or indexing it.
+		 * @details For bulk loads, which index every name at once with reindex
+		 *          afterwards instead of probing the index once per name.
+		 * @param name Name
+		 * @return Name ID
+		 */
+		NameId append_unindexed(std::string_view name);
+
+		/**
+		 * Rebuilds the index, e.g. after names were added with append_unindexed.
+		 */
+		void reindex();
+
+		/**
+		 * Gets a name as a NUL-terminated string.
+		 * @param id Name ID
+		 * @return Name characters, valid until the table next grows
+		 */
+		const char* c_str(NameId id) const { return characters.data() + offsets[id]; }
+
+		/**
+		 * Gets a name.
+		 * @param id Name ID
+		 * @return Name characters, valid until the table next grows
+		 */
+		std::string_view view(NameId id) const { return { c_str(id), offsets[id + 1] - offsets[id] - 1 }; }
+
+		/**
+		 * Removes all names, keeping allocated capacity.
+		 */
+		void clear() { truncate(0); }
+
+		/**
+		 * Removes every name after the first few, keeping allocated capacity.
+		 * @param count Number of names to keep
+		 */
+		void truncate(std::size_t count);
+
+		/**
+		 * Reserves capacity for names.
+		 * @param count Number of names
+		 * @param characters Total length of the names
+		 */
+		void reserve(std::size_t count, std::size_t characters);
+
+		/**
+		 * Gets the number of names.
+		 * @return Name count
+		 */
+		std::size_t size() const { return offsets.size() - 1; }
+
+		/**
+		 * Measures the heap capacity held by the arena, offsets and index.
+		 * @return Allocated bytes
+		 */
+		std::size_t capacity_bytes() const;
+
+	private:
+		static constexpr NameId empty_slot = no_name;
+
+		std::vector<char> characters;
+		// Start of each name in characters, followed by the end of the last name
+		std::vector<std::uint32_t> offsets{ 0 };
+		// Name IDs by hash, a power of two in size and at most half full
+		std::vector<NameId> slots;
+
+		/**
+		 * Finds the slot holding a name, or the empty slot where it would go.
+		 * @param name Name
+		 * @return Slot index
+		 */
+		std::size_t find_slot(std::string_view name) const;
+
+		/**
+		 * Resizes and refills the index.
+		 * @param slot_count New slot count, a power of two
+		 */
+		void rehash(std::size_t slot_count);
+	};
 
-		AABB aabb(Position position, float scale) const override;
-		Shape* clone() const override { return new Rectangle{ *this }; }
-		void draw(Position position, float scale, Color color) const override;
+	/**
+	 * Heap capacity held by an entity store, split by what it holds.
+	 */
+	struct StoreMemory {
+		// Positions, velocities, scales, colors and active flags
+		std::size_t components = 0;
+		// Shape types, extents, and the shape and active index lists
+		std::size_t shapes = 0;
+		// Name IDs, the name table and nametag extents
+		std::size_t names = 0;
 	};
 
 	/**
-	 * Game entity
+	 * Structure-of-arrays storage for game entities.
+	 * @details Each component lives in its own contiguous array, indexed by handle,
+	 *          so the simulation and rendering loops only stream the data they read.
 	 */
-	class Entity {
+	class EntityStore {
 	public:
-		std::string name;
-		Position position;
-		Velocity velocity;
-		std::unique_ptr<Shape> shape;
-		float scale = 1.0f;
-		Color color;
-		bool is_active = false;
+		// Names are interned in name_table; entities with equal names share an ID
+		std::vector<NameId> names;
+		NameTable name_table;
+		std::vector<float> position_x;
+		std::vector<float> position_y;
+		// Positions at the start of the last simulation step, and positions
+		// interpolated between them and the current ones for rendering
+		std::vector<float> previous_x;
+		std::vector<float> previous_y;
+		std::vector<float> render_x;
+		std::vector<float> render_y;
+		// Velocities in pixels per second
+		std::vector<float> velocity_x;
+		std::vector<float> velocity_y;
+		std::vector<float> scales;
+		std::vector<Color> colors;
+		std::vector<ShapeType> shape_types;
+		// Shape half-extents before scaling (radius for circles)
+		std::vector<float> extent_x;
+		std::vector<float> extent_y;
+		std::vector<std::uint8_t> is_active;
+		// Generation of each slot, bumped when the slot is despawned and again when
+		// it is reused, so it is odd exactly while the slot is free
+		std::vector<std::uint32_t> generations;
+		// Entity indices grouped by shape type, in insertion order
+		std::array<std::vector<std::uint32_t>, shape_type_count> shape_groups;
+		// Despawned slots by shape type. A freed slot keeps its place in its shape
+		// group, so a spawn of the same type reuses it without moving any index
+		std::array<std::vector<std::uint32_t>, shape_type_count> free_slots;
+		// Active entities as packed index lists: shape_groups without the inactive
+		// entities, and maximal runs of active indices in ascending order. Kept in
+		// step with is_active by add, reshape and update_active_set
+		std::array<std::vector<std::uint32_t>, shape_type_count> active_groups;
+		std::vector<IndexRange> active_ranges;
+		// Nametag extents by name ID, measured at name_text_size by measure_names;
+		// names listed in stale_names have not been measured since they were added
+		std::vector<float> name_width;
+		std::vector<float> name_height;
+		std::vector<NameId> stale_names;
+		float name_text_size = 0.0f;
+
+		/**
+		 * Appends an entity to the store directly from its components.
+		 * @param name Entity name
+		 * @param position Coordinates in pixels
+		 * @param velocity Velocity in pixels per second
+		 * @param shape Entity shape
+		 * @param scale Scale factor
+		 * @param color Fill color
+		 * @param is_active Whether the entity is simulated and drawn
+		 * @return Handle to the new entity
+		 */
+		EntityHandle add(std::string_view name, Position position, Velocity velocity, const Shape& shape, float scale, Color color, bool is_active);
+
+		/**
+		 * Appends copies of every entity in another store, skipping its despawned slots.
+		 * @param other Store to copy from
+		 */
+		void append(const EntityStore& other);
+
+		/**
+		 * Creates an entity in a despawned slot of the same shape type, or appends one if there is none.
+		 * @details A reused slot is written in place without allocating. Unlike add,
+		 *          this does not update the active set; call update_active_set
+		 *          once after a batch of spawns and despawns.
+		 * @param name Entity name
+		 * @param position Coordinates in pixels
+		 * @param velocity Velocity in pixels per second
+		 * @param shape Entity shape
+		 * @param scale Scale factor
+		 * @param color Fill color
+		 * @param is_active Whether the entity is simulated and drawn
+		 * @return Handle to the new entity
+		 */
+		EntityHandle spawn(std::string_view name, Position position, Velocity velocity, const Shape& shape, float scale, Color color, bool is_active);
+
+		/**
+		 * Frees an entity's slot for reuse by spawn, invalidating its handles.
+		 * @details The slot is deactivated and stays in the store; call
+		 *          update_active_set once after a batch of spawns and despawns.
+		 * @param handle Entity handle
+		 * @return false if the handle no longer refers to an entity
+		 */
+		bool despawn(EntityHandle handle);
+
+		/**
+		 * Gets the number of active entities.
+		 * @return Active entity count
+		 */
+		std::size_t active_count() const;
+
+		/**
+		 * Removes all entities, keeping allocated capacity.
+		 */
+		void clear();
+
+		/**
+		 * Renames an entity, marking its nametag extent stale if the name changed.
+		 * @param handle Entity handle
+		 * @param name New name
+		 */
+		void rename(EntityHandle handle, std::string_view name);
+
+		/**
+		 * Replaces the shape of an entity, moving it between shape groups if its type changed.
+		 * @param handle Entity handle
+		 * @param shape New shape
+		 */
+		void reshape(EntityHandle handle, const Shape& shape);
+
+		/**
+		 * Gets an entity's name.
+		 * @param i Entity index
+		 * @return NUL-terminated name, valid until the name table next grows
+		 */
+		const char* name(std::size_t i) const { return name_table.c_str(names[i]); }
+
+		/**
+		 * Gets an entity's shape before scaling.
+		 * @param i Entity index
+		 * @return Entity shape
+		 */
+		Shape shape(std::size_t i) const;
+
+		/**
+		 * Interns a name, adding a stale nametag extent if the name is new.
+		 * @param name Name
+		 * @return Name ID
+		 */
+		NameId intern_name(std::string_view name);
+
+		/**
+		 * Checks whether a handle refers to an entity in the store.
+		 * @param handle Entity handle
+		 * @return true if the handle is valid
+		 */
+		bool contains(EntityHandle handle) const {
+			return handle.index < names.size() && generations[handle.index] == handle.generation && (handle.generation & 1) == 0;
+		}
+
+		/**
+		 * Gets a handle to the entity currently in a slot.
+		 * @param i Entity index
+		 * @return Entity handle
+		 */
+		EntityHandle handle(std::size_t i) const { return { static_cast<std::uint32_t>(i), generations[i] }; }
+
+		/**
+		 * Checks whether a slot holds an entity, rather than being free for reuse.
+		 * @param i Entity index
+		 * @return true if the slot was not despawned
+		 */
+		bool is_alive(std::size_t i) const { return (generations[i] & 1) == 0; }
 
 		/**
-		 * Creates a default deactivated entity.
+		 * Gets the number of entities not despawned.
+		 * @return Live entity count
 		 */
-		Entity() = default;
+		std::size_t live_count() const;
 
 		/**
-		 * Copy constructor (deep copy)
-		 * @param other Entity object to copy
+		 * Measures the heap capacity held by the store, including unused capacity.
+		 * @return Allocated bytes by part
 		 */
-		Entity(const Entity& other);
+		StoreMemory memory() const;
 
 		/**
-		 * Move constructor
-		 * @param other Entity object to move from
+		 * Reserves capacity in every component array.
+		 * @param count Number of entities
+		 * @param name_characters Total length of the entity names, if known
 		 */
-		Entity(Entity&& other) noexcept;
+		void reserve(std::size_t count, std::size_t name_characters = 0);
 
 		/**
-		 * Destructor
+		 * Gets the number of slots in the store, including despawned ones.
+		 * @return Slot count
 		 */
-		~Entity() = default;
+		std::size_t size() const { return names.size(); }
 
 		/**
-		 * Copy assignment operator (deep copy)
-		 * @param right Entity object to copy
-		 * @return self (for chaining)
+		 * Rebuilds the active index lists from is_active.
+		 * @details Must be called after writing is_active directly. Bulk edits
+		 *          write every flag first and rebuild once, in one pass over the store.
 		 */
-		Entity& operator =(const Entity& right);
+		void update_active_set();
 
 		/**
-		 * Move assignment operator
-		 * @param right Entity object to move from
-		 * @return self (for chaining)
+		 * Updates the active index lists after is_active was written at a few slots.
+		 * @details Each slot is inserted into or erased from the sorted lists, which
+		 *          shifts their tails, so a larger batch is rebuilt in one pass instead.
+		 * @param slots Entity indices, in any order and possibly repeated
 		 */
-		Entity& operator =(Entity&& right) noexcept;
+		void update_active_set(const std::vector<std::uint32_t>& slots);
 	};
 
 	/**
-	 * Game configuration for window settings, font information, and starting entity data.
+	 * Game configuration for window settings, world bounds, font information, and starting entity data.
 	 */
 	struct Config {
 		Window window;
+		World world;
+		// false when the config has no World line and the world follows the window size
+		bool has_world = false;
 		FontAsset font_asset;
-		std::vector<Entity> entity_templates;
+		EntityStore entity_templates;
 	};
 
 	/**
-	 * Payload for input with Dear ImGui
+	 * Read-only view of a whole file, memory-mapped where the platform allows.
+	 * @details Falls back to reading the file into memory on Windows.
 	 */
-	struct Input {
+	class MappedFile {
 	public:
-		bool draw_shapes_enabled = true;
-		bool draw_text_enabled = true;
-		bool simulate_enabled = true;
-		std::size_t selected_index = 0;
-		bool is_active = true;
-		float scale = 1.0f;
-		float velocity[2] ={ 0.0f, 0.0f };
-		float color[3] ={ 1.0f, 1.0f, 1.0f };
-		std::string name;
-		float text_size;
-		float text_color[3] ={ 1.0f, 1.0f, 1.0f };
+		/**
+		 * Maps the specified file.
+		 * @param path File path
+		 */
+		explicit MappedFile(const std::filesystem::path& path);
+
+		/**
+		 * Unmaps the file.
+		 */
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator =(const MappedFile&) = delete;
+
+		/**
+		 * Checks whether the file was opened.
+		 * @return true if the contents are available
+		 */
+		bool is_open() const { return opened; }
+
+		/**
+		 * Gets the file contents.
+		 * @return File contents, empty if not opened
+		 */
+		std::string_view text() const { return { data, size }; }
+
+	private:
+		const char* data = nullptr;
+		std::size_t size = 0;
+		bool opened = false;
+#if defined(_WIN32)
+		std::string contents;
+#endif
 	};
 
 	/**
-	 * Reads game config from an input stream.
-	 * @details Each line may contain one of the following, in any order:
-	 *     - Window [Caption] [Width] [Height]
-	 *     - Font [File] [Size] [Red] [Green] [Blue]
-	 *     - Rectangle [Name] [X] [Y] [X Velocity] [Y Velocity] [Red] [Green] [Blue] [Width] [Height]
-	 *     - Circle [Name] [X] [Y] [X Velocity] [Y Velocity] [Red] [Green] [Blue] [Radius]
-	 * @param input Input stream
-	 * @param obj Game config
-	 * @return Input stream (for chaining)
+	 * Watches a config file for changes by polling its modification time.
+	 * @details Keeps the text last applied to the scene, so a reload can diff the
+	 *          file against it. Text that fails to apply is not accepted, and the
+	 *          next change is diffed against the last accepted text again.
 	 */
-	std::istream& operator >>(std::istream& input, Config& obj);
+	class ConfigWatcher {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Minimum time between checks of the file.
+		 */
+		static constexpr auto poll_interval = std::chrono::milliseconds{ 250 };
+
+		/**
+		 * Creates a watcher of no file, which never reports a change.
+		 */
+		ConfigWatcher() = default;
+
+		/**
+		 * Starts watching a file, taking its current contents as applied.
+		 * @param path Config file path
+		 */
+		explicit ConfigWatcher(std::filesystem::path path);
+
+		/**
+		 * Checks whether the file changed, reading it if so.
+		 * @return true if new contents are pending
+		 */
+		bool poll();
+
+		/**
+		 * Takes the pending contents as applied.
+		 */
+		void accept() { applied_text.swap(pending_text); }
+
+		/**
+		 * Gets the watched file path.
+		 * @return Config file path
+		 */
+		const std::filesystem::path& path() const { return file_path; }
+
+		/**
+		 * Gets the contents last applied to the scene.
+		 * @return File contents
+		 */
+		std::string_view applied() const { return applied_text; }
+
+		/**
+		 * Gets the contents read by the last successful poll.
+		 * @return File contents
+		 */
+		std::string_view pending() const { return pending_text; }
+
+	private:
+		std::filesystem::path file_path;
+		std::filesystem::file_time_type write_time{};
+		Clock::time_point next_poll{};
+		std::string applied_text;
+		std::string pending_text;
+	};
 
 	/**
-	 * Updates input fields following selection of new entity.
-	 * @param input Input data payload
-	 * @param entities Game entities
+	 * Summary of the changes applied by reload_config.
 	 */
-	void change_selection(Input& input, const std::vector<Entity>& entities);
+	struct ConfigChanges {
+		std::size_t added = 0;
+		std::size_t changed = 0;
+		std::size_t removed = 0;
+		bool window = false;
+		bool world = false;
+		bool font = false;
+	};
 
 	/**
-	 * Draws an entity's name to the screen with raylib.
-	 * @param entity Entity object to draw
-	 * @param font raylib font data
-	 * @param font_size Text font size
-	 * @param color Text color
+	 * Header of a binary scene snapshot.
+	 * @details The header is followed by packed sections in native byte order,
+	 *          each holding entity_count values unless noted:
+	 *              position_x, position_y, velocity_x, velocity_y, scales,
+	 *              extent_x, extent_y, colors, name IDs,
+	 *              name_count + 1 offsets into the name characters,
+	 *              shape_types, is_active, generations,
+	 *              and name_bytes of name characters.
+	 *          Velocities are in pixels per second, as in EntityStore. Names are
+	 *          the store's name table in ID order, without terminators. Despawned
+	 *          slots are kept, so indices match the store the snapshot was taken of.
 	 */
-	void draw_name(const Input& input, const Entity& entity, const Font& font);
+	struct SnapshotHeader {
+		std::array<char, 4> magic ={ 'A', '1', 'S', 'S' };
+		std::uint32_t version = 3;
+		std::uint32_t entity_count = 0;
+		std::uint32_t name_count = 0;
+		std::uint32_t name_bytes = 0;
+	};
 
 	/**
-	 * Draws an entity's shape to the screen with raylib.
-	 * @param entity Entity object to draw
+	 * Simulation settings and drawing toggles captured in a session recording.
 	 */
-	void draw_shape(const Entity& entity);
+	struct SessionSettings {
+		std::uint8_t simulate_enabled = 1;
+		std::uint8_t parallel_enabled = 0;
+		std::uint8_t collide_enabled = 0;
+		std::uint8_t draw_shapes_enabled = 1;
+		std::uint8_t draw_text_enabled = 1;
+		std::uint8_t instancing_enabled = 1;
+		std::uint8_t wrap_enabled = 0;
+		std::uint8_t padding = 0;
+		std::int32_t thread_count = 0;
+		std::int32_t min_chunk_size = 16384;
+		std::int32_t max_catch_up_steps = 5;
+		float tick_rate = 60.0f;
+		float text_size = 18.0f;
+		float gravity = 0.0f;
+		float damping = 0.0f;
+
+		friend bool operator ==(const SessionSettings& left, const SessionSettings& right) = default;
+	};
 
 	/**
-	 * Syncs input and game state.
-	 * @details Updates entity's components following user input. When a new entity
-	 *          is selected, the input fields are updated to reflect the new data.
-	 * @param input Input data payload
-	 * @param previous_input Previous input data payload
-	 * @param entities Game entities
+	 * Header of a recorded session.
+	 * @details The header is followed by the starting scene as a snapshot of
+	 *          state_bytes bytes (see SnapshotHeader), then event_bytes bytes of
+	 *          frame records. Each record holds its frame number and recorded flags
+	 *          (InputChange and session_settings_changed) as two std::uint32_t, then
+	 *          the values of each flag in ascending bit order:
+	 *              selection: primary index, count, and count selected indices
+	 *              is_active: std::uint8_t
+	 *              scale, velocity_x, velocity_y: float
+	 *              color: 3 floats
+	 *              name: length and characters
+	 *              scene: snapshot length and snapshot
+	 *              session_settings_changed: SessionSettings
+	 *          Indices and lengths are std::uint32_t, in native byte order.
 	 */
-	void handle_input(Input& input, const Input& previous_input, std::vector<Entity>& entities);
+	struct SessionHeader {
+		std::array<char, 4> magic ={ 'A', '1', 'R', 'P' };
+		std::uint32_t version = 2;
+		std::int32_t world_width = 0;
+		std::int32_t world_height = 0;
+		std::uint32_t frame_count = 0;
+		std::uint32_t state_bytes = 0;
+		std::uint32_t event_bytes = 0;
+	};
 
 	/**
-	 * Provides input fields for universal controls.
-	 * @param input Input data payload
+	 * Session record flag for changed settings, above the InputChange flags.
 	 */
-	void handle_all_shape_controls_ui(Input& input);
+	inline constexpr std::uint32_t session_settings_changed = 1u << 31;
 
 	/**
-	 * Renders current game state with raylib.
-	 * @param input Input data payload
-	 * @param font raylib font for entity nametags
-	 * @param font_asset Font asset for entity nametag size & color
-	 * @param entities Game entities
+	 * Set of selected entities.
+	 * @details Keeps the selected indices, for batched edits, alongside a
+	 *          per-entity membership flag, for constant-time lookups in lists.
 	 */
-	void handle_rendering(const Input& input, const Font& font, const FontAsset& font_asset, const std::vector<Entity>& entities);
+	class Selection {
+	public:
+		std::vector<std::uint32_t> indices;
+		std::vector<std::uint8_t> is_selected;
+
+		/**
+		 * Adds an entity to the selection.
+		 * @param i Entity index
+		 */
+		void add(std::uint32_t i);
+
+		/**
+		 * Removes an entity from the selection.
+		 * @param i Entity index
+		 */
+		void remove(std::uint32_t i);
+
+		/**
+		 * Deselects every entity, in time proportional to the selection size.
+		 */
+		void clear();
+
+		/**
+		 * Checks whether an entity is selected.
+		 * @param i Entity index
+		 * @return true if selected
+		 */
+		bool contains(std::uint32_t i) const { return i < is_selected.size() && is_selected[i]; }
+
+		/**
+		 * Sizes the membership flags for a store, clearing the selection if its size changed.
+		 * @param count Number of entities
+		 */
+		void resize(std::size_t count);
+	};
 
 	/**
-	 * Provides button to reset all game state.
-	 * @param input Input data payload
-	 * @param entity_templates Source of game entities to copy
-	 * @param entities Game entities
-	 * @param font_asset Font asset for entity nametag size & color
+	 * Selected-entity input fields, as bit flags marking UI edits not yet synced.
 	 */
-	void handle_reset_ui(Input& input, const std::vector<Entity>& entity_templates, std::vector<Entity>& entities, const FontAsset& font_asset);
+	enum class InputChange : std::uint32_t {
+		selection = 1 << 0,
+		is_active = 1 << 1,
+		scale = 1 << 2,
+		velocity_x = 1 << 3,
+		velocity_y = 1 << 4,
+		color = 1 << 5,
+		name = 1 << 6,
+		// Camera or drawing settings, which only invalidate the cached scene
+		view = 1 << 7,
+		// The entity store was replaced (reset or snapshot load) or changed in
+		// bulk, outdating any copy of it
+		scene = 1 << 8,
+		// Entities were spawned or despawned in the slots listed in
+		// Input::spawn_slots, which copies of the store update in place
+		spawn = 1 << 9
+	};
 
 	/**
-	 * Provides input fields for selected entity.
-	 * @param input Input data payload
-	 * @param entities Game entities
+	 * Optional motion features, as bit flags selecting an integration kernel variant.
+	 * @details Without wrap, shapes bounce off the edges of the world.
 	 */
-	void handle_selected_shape_ui(Input& input, std::vector<Entity>& entities);
+	enum class MotionFeature : std::uint32_t {
+		wrap = 1 << 0,
+		gravity = 1 << 1,
+		damping = 1 << 2
+	};
 
 	/**
-	 * Updates game physics simulation.
-	 * @param input Input data payload
-	 * @param window Containing window
-	 * @param entities Game entities
+	 * Number of MotionFeature combinations, each with its own kernel variant.
 	 */
-	void handle_simulation(const Input& input, const Window& window, std::vector<Entity>& entities);
+	inline constexpr std::size_t motion_variant_count = 8;
 
 	/**
-	 * Provides input fields for nametag font size & color.
-	 * @param input Input data payload
+	 * Edge behaviour and forces applied by move.
 	 */
-	void handle_text_ui(Input& input);
+	struct MotionSettings {
+		// Shapes leaving one edge of the world reappear at the opposite edge
+		bool wrap = false;
+		// Downward acceleration in pixels per second squared
+		float gravity = 0.0f;
+		// Fraction of velocity lost per second, as an exponential decay rate
+		float damping = 0.0f;
+
+		/**
+		 * Gets the enabled features.
+		 * @return MotionFeature flags
+		 */
+		std::uint32_t features() const;
+	};
 
 	/**
-	 * Populates input fields with initial values.
-	 * @param input Input data payload
-	 * @param entities Game entities
-	 * @param font_asset Font asset for entity nametag size & color
+	 * Distributions of generated entities, each value drawn uniformly from its range.
 	 */
-	void initialize_ui(Input& input, const std::vector<Entity>& entities, const FontAsset& font_asset);
+	struct GeneratorSettings {
+		int count = 10000;
+		// Fraction of entities that are circles, the rest are rectangles
+		float circle_fraction = 0.5f;
+		// Shape half-extents (radius for circles) in pixels
+		float min_extent = 2.0f;
+		float max_extent = 12.0f;
+		// Speeds in pixels per second, in a uniformly random direction
+		float min_speed = 0.0f;
+		float max_speed = 300.0f;
+		// Fill color channels
+		float min_color[3] ={ 0.0f, 0.0f, 0.0f };
+		float max_color[3] ={ 1.0f, 1.0f, 1.0f };
+		std::uint32_t seed = 1;
+	};
 
 	/**
-	 * Loads game configuration from the specified file path.
-	 * @param path Input file path
-	 * @throws std::runtime_error if file not read
-	 * @return Input stream (for chaining)
-*
+	 * On-screen size thresholds for simplifying shapes and nametags, in pixels.
 	 */
-	Config load_config(const std::filesystem::path& path);
+	struct LevelOfDetail {
+		// Circles smaller than this across are drawn as plain squares
+		float point_size = 3.0f;
+		// Length of each edge segment of a circle, which sets its segment count
+		float segment_length = 4.0f;
+		// Nametags drawn smaller than this are hidden
+		float min_text_size = 6.0f;
+	};
 
 	/**
-	 * Moves entity, adjusting position and velocity.
-	 * @details If the entity shape collides with the window bounds, the velocity
-				vector is adjusted in the x and/or y direction so the shape will
-				bounce off the edge of the window.
-	 * @param entity Entity object to move
-	 * @param window Containing window
+	 * Payload for input with Dear ImGui
 	 */
-	void move(Entity& entity, const Window& window);
+	struct Input {
+	public:
+		// Edits apply to every entity in selection; selected is the primary
+		// entity whose values the input fields show
+		bool draw_shapes_enabled = true;
+		bool instancing_enabled = true;
+		bool draw_text_enabled = true;
+		bool simulate_enabled = true;
+		bool parallel_enabled = false;
+		bool collide_enabled = false;
+		bool pipeline_enabled = false;
+		// Simulate in a compute shader, when the GPU backend loaded (gpu_available)
+		bool gpu_enabled = false;
+		bool gpu_available = false;
+		MotionSettings motion;
+		int thread_count = 0;
+		int min_chunk_size = 16384;
+		float tick_rate = 60.0f;
+		int max_catch_up_steps = 5;
+		int target_fps = 60;
+		// World view, panned by dragging with the right or middle mouse button
+		// and zoomed around the cursor with the wheel
+		Camera2D camera{ { 0.0f, 0.0f }, { 0.0f, 0.0f }, 0.0f, 1.0f };
+		bool scene_cache_enabled = false;
+		LevelOfDetail lod;
+		GeneratorSettings generator;
+		// Spawn and despawn requests from the UI, applied by handle_spawning
+		// before the frame's edits are synced; spawn_template is a template index
+		int spawn_template = 0;
+		int spawn_count = 1;
+		bool spawn_requested = false;
+		bool despawn_requested = false;
+		// Slots written by this frame's spawns and despawns (see InputChange::spawn)
+		std::vector<std::uint32_t> spawn_slots;
+		EntityHandle selected;
+		bool is_active = true;
+		float scale = 1.0f;
+		float velocity[2] ={ 0.0f, 0.0f };
+		float color[3] ={ 1.0f, 1.0f, 1.0f };
+		std::string name;
+		float text_size;
+		float text_color[3] ={ 1.0f, 1.0f, 1.0f };
+		Selection selection;
+		// Entity list filter (name pattern, and 0 for any shape or else ShapeType + 1)
+		// with the matching entity indices, rebuilt when filter_dirty is set
+		std::string filter;
+		int filter_shape = 0;
+		std::vector<std::uint32_t> filtered;
+		bool filter_dirty = true;
+		// World-space box selection in progress
+		bool is_box_selecting = false;
+		float box_start[2] ={ 0.0f, 0.0f };
+		float box_end[2] ={ 0.0f, 0.0f };
+		// InputChange flags set by the UI and cleared by handle_input
+		std::uint32_t changes = 0;
+
+		/**
+		 * Marks a field as edited.
+		 * @param change Edited field
+		 */
+		void mark(InputChange change) { changes |= static_cast<std::uint32_t>(change); }
+
+		/**
+		 * Checks whether a field was edited since the last sync.
+		 * @param change Field
+		 * @return true if the field was edited
+		 */
+		bool changed(InputChange change) const { return (changes & static_cast<std::uint32_t>(change)) != 0; }
+	};
 
 	/**
-	 * Reads an entity with a circle from an input stream.
-	 * @param input Input stream
-	 * @param obj Game entity
-	 * @return Input stream (for chaining)
+	 * Per-instance shape data for the instanced renderer.
 	 */
-	std::istream& read_circle_entity(std::istream& input, Entity& obj);
+	struct ShapeInstance {
+		float x = 0.0f;
+		float y = 0.0f;
+		// Scaled half-extents (radius for circles)
+		float half_width = 0.0f;
+		float half_height = 0.0f;
+		// RGBA8, red in the lowest byte
+		std::uint32_t color = 0;
+		float shape_type = 0.0f;
+	};
 
 	/**
-	 * Reads an entity's common components (i.e. not the shape) from an input stream.
-	 * @param input Input stream
-	 * @param obj Game entity
-	 * @return Input stream (for chaining)
+	 * Draws every active shape with a single instanced draw call through rlgl.
+	 * @details Instances are grouped by shape type, circles before rectangles, the
+	 *          same order as draw_shapes. The shader cuts circles out of quads.
+	 *          Instance data is built in chunks of the grouped entity order, which
+	 *          worker threads can fill in parallel; only the upload and draw call
+	 *          run on the GL thread.
 	 */
-	std::istream& read_common_components(std::istream& input, Entity& obj);
+	class ShapeRenderer {
+	public:
+		/**
+		 * Loads the shape shader and GPU buffers.
+		 * @param vs_path Vertex shader file path
+		 * @param fs_path Fragment shader file path
+		 * @return true if the renderer is ready to draw
+		 */
+		bool load(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path);
+
+		/**
+		 * Releases the shader and GPU buffers.
+		 */
+		void unload();
+
+		/**
+		 * Checks whether the shader and GPU buffers are loaded.
+		 * @return true if the renderer is ready to draw
+		 */
+		bool is_ready() const { return vao != 0; }
+
+		/**
+		 * Draws the shapes of all active entities inside the view.
+		 * @param entities Game entities
+		 * @param view Visible world area
+		 * @param point_size Circles smaller than this across, in world units, are drawn as squares
+		 * @return Number of draw calls issued
+		 */
+		std::size_t draw(const EntityStore& entities, const AABB& view, float point_size);
+
+		/**
+		 * Draws the shapes of all active entities inside the view, building the
+		 * instance data across threads.
+		 * @details Falls back to a serial build when the store is too small to give
+		 *          more than one chunk.
+		 * @param entities Game entities
+		 * @param view Visible world area
+		 * @param point_size Circles smaller than this across, in world units, are drawn as squares
+		 * @param thread_count Maximum number of threads, or 0 for all available
+		 * @param min_chunk_size Minimum number of entities per thread
+		 * @return Number of draw calls issued
+		 */
+		std::size_t draw_parallel(const EntityStore& entities, const AABB& view, float point_size, int thread_count, std::size_t min_chunk_size);
+
+		/**
+		 * Draws instances that are already in a GPU buffer, e.g. written by GpuSimulation.
+		 * @param buffer Buffer of ShapeInstance records
+		 * @param count Number of instances
+		 * @return Number of draw calls issued
+		 */
+		std::size_t draw_buffer(unsigned int buffer, std::size_t count);
+
+		/**
+		 * Gets the size of the GPU instance buffer.
+		 * @return Allocated bytes
+		 */
+		std::size_t gpu_bytes() const { return instance_capacity * sizeof(ShapeInstance); }
+
+	private:
+		Shader shader{};
+		int mvp_location = -1;
+		unsigned int vao = 0;
+		unsigned int quad_vbo = 0;
+		unsigned int instance_vbo = 0;
+		std::size_t instance_capacity = 0;
+		// Vertex array for draw_buffer, pointed at the caller's buffer on each draw
+		unsigned int buffer_vao = 0;
+		// Instance data of each chunk, uploaded back to back in chunk order
+		std::vector<std::vector<ShapeInstance>> chunk_instances;
+
+		/**
+		 * Builds the instance data of one chunk of the grouped active entity order.
+		 * @param entities Game entities
+		 * @param view Visible world area
+		 * @param begin First position in the grouped order (active circles, then active rectangles)
+		 * @param end Position one past the last in the grouped order
+		 * @param point_size Circles smaller than this across, in world units, are drawn as squares
+		 * @param instances Instance data of the visible active entities, replaced
+		 */
+		static void build(const EntityStore& entities, const AABB& view, std::size_t begin, std::size_t end, float point_size, std::vector<ShapeInstance>& instances);
+
+		/**
+		 * Uploads the instance data of the first chunks and draws them in one call.
+		 * @param chunk_count Number of chunks built
+		 * @return Number of draw calls issued
+		 */
+		std::size_t submit(std::size_t chunk_count);
+
+		/**
+		 * Points the instance attributes of the bound vertex array at the bound array buffer.
+		 */
+		static void set_instance_attributes();
+	};
 
 	/**
-	 * Reads an entity with a rectangle from an input stream.
-	 * @param input Input stream
-	 * @param obj Game entity
-	 * @return Input stream (for chaining)
+	 * Per-instance glyph data for the text renderer.
 	 */
-	std::istream& read_rectangle_entity(std::istream& input, Entity& obj);
+	struct GlyphInstance {
+		// Top-left corner and size of the glyph quad in world units
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 0.0f;
+		float height = 0.0f;
+		// Atlas texture coordinates of the quad's top-left and bottom-right corners
+		float u0 = 0.0f;
+		float v0 = 0.0f;
+		float u1 = 0.0f;
+		float v1 = 0.0f;
+	};
 
 	/**
-	 * Updates selected entity & corresponding input fields.
-	 * @param input Input data payload
-	 * @param entities Game entities
+	 * Draws every visible nametag with a single instanced draw call from a signed distance field glyph atlas.
+	 * @details The font is rasterized once as distance fields at sdf_font_size, so
+	 *          glyphs keep sharp edges at any text size or zoom. Each glyph is one
+	 *          instanced quad, laid out the same way as raylib's DrawTextEx so the
+	 *          extents from measure_names still match.
 	 */
-	void update_selection(Input& input, const Input& previous_input, std::vector<Entity>& entities);
-}
+	class TextRenderer {
+	public:
+		// Size the distance fields are rasterized at, independent of the drawn size
+		static constexpr int sdf_font_size = 64;
 
-//------------------------------------------------------------------------------------
-// Program main entry point
-//------------------------------------------------------------------------------------
-int main(void) {
-	// Initialization
-	//--------------------------------------------------------------------------------------
-	const auto input_path = std::filesystem::path{ "assets/input.txt" };
-	const auto [window, font_asset, entity_templates] = a1::load_config(input_path);
-	auto entities = std::vector<a1::Entity>{};
-	entities.reserve(entity_templates.size());
-	std::copy(entity_templates.begin(), entity_templates.end(), std::back_inserter(entities));
+		/**
+		 * Builds the glyph atlas and loads the text shader and GPU buffers.
+		 * @param font_path TrueType font file path
+		 * @param vs_path Vertex shader file path
+		 * @param fs_path Fragment shader file path
+		 * @return true if the renderer is ready to draw
+		 */
+		bool load(const std::filesystem::path& font_path, const std::filesystem::path& vs_path, const std::filesystem::path& fs_path);
 
-	SetConfigFlags(FLAG_WINDOW_HIGHDPI);
-	InitWindow(window.width, window.height, window.caption.c_str());
+		/**
+		 * Rasterizes the glyph distance fields and packs them into an atlas image.
+		 * @details Makes no OpenGL calls, so it may run on another thread while
+		 *          the renderer is not loaded; upload then finishes loading.
+		 * @param font_path TrueType font file path
+		 * @return false if the font could not be read
+		 */
+		bool prepare(const std::filesystem::path& font_path);
 
-	//initialize the raylib ImGui backend
-	rlImGuiSetup(true);
-	//increase ImGui item size to 2x
-	ImGui::GetStyle().ScaleAllSizes(2);
+		/**
+		 * Uploads the prepared glyph atlas and loads the text shader and GPU buffers.
+		 * @param vs_path Vertex shader file path
+		 * @param fs_path Fragment shader file path
+		 * @return true if the renderer is ready to draw
+		 */
+		bool upload(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path);
 
-	// Set raylib to target 60 frames-per-second (this does not mean it will actually RUN at 60 fps)
-	SetTargetFPS(60);
+		/**
+		 * Releases the glyph atlas, shader and GPU buffers.
+		 */
+		void unload();
 
-	// General variables
-	//--------------------------------------------------------------------------------------
-	auto input = a1::Input{};
-	auto previous_input = a1::Input{};
-	const auto font = LoadFont(font_asset.file.string().c_str());
+		/**
+		 * Checks whether the atlas, shader and GPU buffers are loaded.
+		 * @return true if the renderer is ready to draw
+		 */
+		bool is_ready() const { return vao != 0; }
 
-	initialize_ui(input, entities, font_asset);
+		/**
+		 * Gets the distance field font, for measuring nametags.
+		 * @return raylib font data
+		 */
+		const Font& font() const { return sdf_font; }
 
-	// Main game loop
-	//--------------------------------------------------------------------------------------
-	// Detect window close button or ESC key
-	while( !WindowShouldClose() ) {
-		// Update
-		//----------------------------------------------------------------------------------
-		handle_input(input, previous_input, entities);
-		previous_input = input;
-		handle_simulation(input, window, entities);
+		/**
+		 * Draws the names of all active entities inside the view.
+		 * @param input Input data payload (text size & color)
+		 * @param entities Game entities
+		 * @param view Visible world area
+		 * @return Number of draw calls issued
+		 */
+		std::size_t draw(const Input& input, const EntityStore& entities, const AABB& view);
+
+		/**
+		 * Gets the size of the GPU instance buffer, not counting the glyph atlas.
+		 * @return Allocated bytes
+		 */
+		std::size_t gpu_bytes() const { return instance_capacity * sizeof(GlyphInstance); }
+
+	private:
+		Font sdf_font{};
+		// Atlas built by prepare, until upload moves it into sdf_font.texture
+		Image atlas{};
+		Shader shader{};
+		int mvp_location = -1;
+		int color_location = -1;
+		int texture_location = -1;
+		unsigned int vao = 0;
+		unsigned int quad_vbo = 0;
+		unsigned int instance_vbo = 0;
+		std::size_t instance_capacity = 0;
+		// Glyph index of each ASCII character, skipping raylib's linear glyph search
+		std::array<int, 128> ascii_glyphs{};
+		std::vector<GlyphInstance> instances;
+
+		/**
+		 * Lays out the glyphs of every visible nametag.
+		 * @param input Input data payload (text size)
+		 * @param entities Game entities
+		 * @param view Visible world area
+		 */
+		void build(const Input& input, const EntityStore& entities, const AABB& view);
+
+		/**
+		 * Points the instance attributes of the bound vertex array at the bound array buffer.
+		 */
+		static void set_instance_attributes();
+	};
+
+	/**
+	 * Offscreen copy of the rendered scene, drawn in place of re-recording a paused scene.
+	 * @details The caller invalidates the cache whenever anything it shows may have
+	 *          changed; the next frame then records the scene into it again.
+	 */
+	class SceneCache {
+	public:
+		/**
+		 * Starts recording the scene into the cache, resizing it to the screen if needed.
+		 * @param width Screen width
+		 * @param height Screen height
+		 */
+		void begin(int width, int height);
+
+		/**
+		 * Finishes recording the scene and marks the cache valid.
+		 */
+		void end();
+
+		/**
+		 * Draws the cached scene over the screen.
+		 * @return Number of draw calls issued
+		 */
+		std::size_t draw() const;
+
+		/**
+		 * Marks the cached scene as out of date.
+		 */
+		void invalidate() { valid = false; }
+
+		/**
+		 * Checks whether the cached scene is up to date.
+		 * @return true if the cache can be drawn
+		 */
+		bool is_valid() const { return valid; }
+
+		/**
+		 * Releases the render texture.
+		 */
+		void unload();
+
+		/**
+		 * Estimates the GPU memory of the render texture and its depth buffer.
+		 * @return Allocated bytes
+		 */
+		std::size_t gpu_bytes() const;
+
+	private:
+		RenderTexture2D target{};
+		bool valid = false;
+	};
+
+	/**
+	 * Component arrays and world bounds for one batch integration step.
+	 * @details Entities in the index range [begin, end) are integrated.
+	 */
+	struct IntegrationBatch {
+		float* position_x = nullptr;
+		float* position_y = nullptr;
+		float* velocity_x = nullptr;
+		float* velocity_y = nullptr;
+		const float* extent_x = nullptr;
+		const float* extent_y = nullptr;
+		const float* scales = nullptr;
+		const std::uint8_t* is_active = nullptr;
+		std::size_t begin = 0;
+		std::size_t end = 0;
+		float width = 0.0f;
+		float height = 0.0f;
+		float dt = 0.0f;
+		// Velocity change per step from gravity, and velocity scale per step from damping
+		float gravity = 0.0f;
+		float damping = 1.0f;
+	};
+
+	/**
+	 * Integration kernel variants for one instruction set, indexed by MotionFeature flags.
+	 */
+	using IntegrationVariants = std::array<void (*)(const IntegrationBatch& batch), motion_variant_count>;
+
+	/**
+	 * Batch integration kernel for one instruction set.
+	 */
+	struct IntegrationKernel {
+		const char* name = "Scalar";
+		std::size_t lanes = 1;
+		IntegrationVariants integrate{};
+	};
+
+	/**
+	 * Fixed-timestep accumulator state carried between frames.
+	 */
+	struct SimulationClock {
+		// Unsimulated time in seconds, always less than one tick after a frame
+		double accumulator = 0.0;
+		// Fraction of a tick between the previous and current simulation states
+		float alpha = 1.0f;
+		// Whether the previous frame ran the simulation
+		bool is_running = false;
+
+		/**
+		 * Adds a frame's time and takes whole ticks out of the accumulator.
+		 * @details Any backlog beyond the catch-up cap is dropped, so a long stall
+		 *          slows the simulation down instead of stalling every following
+		 *          frame too. Updates alpha for the time left over.
+		 * @param step Tick length in seconds
+		 * @param max_steps Maximum number of ticks per frame
+		 * @param frame_time Seconds elapsed since the last frame
+		 * @return Number of ticks to simulate
+		 */
+		int advance(double step, int max_steps, float frame_time);
+	};
+
+	/**
+	 * Uniform-grid broad phase and elastic response for entity-entity collisions.
+	 * @details Each tick the grid is rebuilt from the active entities' bounding
+	 *          boxes with a counting sort into reused buffers, so rebuilding is
+	 *          O(N) and allocation-free once the buffers have grown. An entity is
+	 *          listed in every cell its box overlaps; a pair is only tested in the
+	 *          cell holding the top-left corner of the intersection of their boxes,
+	 *          so each pair is tested once however many cells they share.
+	 */
+	class CollisionGrid {
+	public:
+		/**
+		 * Rebuilds the grid and resolves every overlapping pair of active entities.
+		 * @param entities Game entities
+		 * @param world World bounds, the extent of the grid
+		 */
+		void resolve(EntityStore& entities, const World& world);
+
+		/**
+		 * Gets the number of contacts resolved by the last call to resolve.
+		 * @return Contact count
+		 */
+		std::size_t contact_count() const { return contacts; }
+
+	private:
+		float cell_size = 1.0f;
+		int columns = 0;
+		int rows = 0;
+		// Offsets of each cell's run in cell_entities, with one extra end offset
+		std::vector<std::uint32_t> cell_start;
+		std::vector<std::uint32_t> cell_entities;
+		std::size_t contacts = 0;
+
+		/**
+		 * Rebuilds the grid from the active entities' bounding boxes.
+		 * @param entities Game entities
+		 * @param world World bounds
+		 */
+		void build(const EntityStore& entities, const World& world);
+
+		/**
+		 * Gets the range of cells overlapped by a box, clamped to the grid.
+		 * @param aabb Axis aligned bounding box
+		 * @param first_column First column (output)
+		 * @param first_row First row (output)
+		 * @param last_column Last column, inclusive (output)
+		 * @param last_row Last row, inclusive (output)
+		 */
+		void cell_range(const AABB& aabb, int& first_column, int& first_row, int& last_column, int& last_row) const;
+	};
+
+	/**
+	 * Main loop phase measured by the frame profiler.
+	 */
+	enum class ProfilePhase : std::uint8_t {
+		input,
+		simulation,
+		rendering,
+		ui,
+		present
+	};
+
+	/**
+	 * Number of ProfilePhase values.
+	 */
+	inline constexpr std::size_t profile_phase_count = 5;
+
+	/**
+	 * Frame profiler with a ring buffer of recent per-phase timings.
+	 * @details Phases are timed with ProfileScope through the A1_PROFILE_SCOPE
+	 *          macro, which compiles to nothing unless A1_PROFILE is defined
+	 *          (make PROFILE=1).
+	 */
+	class Profiler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Number of frames kept in the history.
+		 */
+		static constexpr std::size_t history_size = 300;
+
+		/**
+		 * Timings for one frame, in milliseconds from the start of the frame.
+		 */
+		struct Frame {
+			Clock::time_point start;
+			float duration_ms = 0.0f;
+			std::array<float, profile_phase_count> phase_start_ms{};
+			std::array<float, profile_phase_count> phase_ms{};
+			std::size_t entities = 0;
+			std::size_t draw_calls = 0;
+		};
+
+		/**
+		 * Starts timing a new frame.
+		 */
+		void begin_frame();
+
+		/**
+		 * Finishes timing the current frame and adds it to the history.
+		 * @param entities Number of entities in the scene
+		 * @param draw_calls Number of draw calls issued
+		 */
+		void end_frame(std::size_t entities, std::size_t draw_calls);
+
+		/**
+		 * Adds time spent in a phase to the current frame.
+		 * @param phase Main loop phase
+		 * @param start Phase start time
+		 * @param end Phase end time
+		 */
+		void record(ProfilePhase phase, Clock::time_point start, Clock::time_point end);
+
+		/**
+		 * Provides an ImGui window with the frame-time graph and per-phase timings.
+		 */
+		void draw_ui();
+
+		/**
+		 * Writes the history as Chrome trace event JSON (chrome://tracing, Perfetto).
+		 * @param path Output file path
+		 * @return true if the file was written
+		 */
+		bool write_chrome_trace(const std::filesystem::path& path) const;
+
+	private:
+		std::array<Frame, history_size> frames{};
+		// Index the next frame is written to, and number of valid frames
+		std::size_t next = 0;
+		std::size_t count = 0;
+		Frame current;
+		Clock::time_point epoch = Clock::now();
+
+		/**
+		 * Gets a frame from the history, oldest first.
+		 * @param age_index 0 for the oldest frame, count - 1 for the newest
+		 * @return Frame timings
+		 */
+		const Frame& frame(std::size_t age_index) const { return frames[(next + history_size - count + age_index) % history_size]; }
+	};
+
+	/**
+	 * Times a main loop phase for as long as the scope lives.
+	 */
+	class ProfileScope {
+	public:
+		/**
+		 * Starts timing a phase.
+		 * @param profiler Frame profiler
+		 * @param phase Main loop phase
+		 */
+		ProfileScope(Profiler& profiler, ProfilePhase phase) : profiler(profiler), phase(phase), start(Profiler::Clock::now()) {}
+
+		/**
+		 * Records the phase timing.
+		 */
+		~ProfileScope() { profiler.record(phase, start, Profiler::Clock::now()); }
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator =(const ProfileScope&) = delete;
+
+	private:
+		Profiler& profiler;
+		ProfilePhase phase;
+		Profiler::Clock::time_point start;
+	};
+
+	/**
+	 * Subsystem that heap allocations are charged to.
+	 */
+	enum class MemoryTag : std::uint8_t {
+		other,
+		config,
+		entities,
+		names,
+		simulation,
+		rendering,
+		ui
+	};
+
+	/**
+	 * Number of MemoryTag values.
+	 */
+	inline constexpr std::size_t memory_tag_count = 7;
+
+	/**
+	 * Heap usage charged to one subsystem since program start.
+	 */
+	struct MemoryUsage {
+		std::size_t live_bytes = 0;
+		std::size_t peak_bytes = 0;
+		std::size_t allocations = 0;
+	};
+
+	/**
+	 * Charges the heap allocations the current thread makes to a subsystem for as long as the scope lives.
+	 * @details Scopes nest, so e.g. names interned while loading the config are
+	 *          charged to names. Threads start out charging MemoryTag::other.
+	 *          Used through the A1_MEMORY_SCOPE macro, which compiles to nothing
+	 *          unless A1_MEMORY is defined (make MEMORY=1).
+	 */
+	class MemoryScope {
+	public:
+		/**
+		 * Starts charging allocations to a subsystem.
+		 * @param tag Subsystem
+		 */
+		explicit MemoryScope(MemoryTag tag);
+
+		/**
+		 * Goes back to charging the enclosing scope's subsystem.
+		 */
+		~MemoryScope();
+
+		MemoryScope(const MemoryScope&) = delete;
+		MemoryScope& operator =(const MemoryScope&) = delete;
+
+	private:
+		MemoryTag previous;
+	};
+
+	/**
+	 * Edits made to the main thread's store since a copy of it was last brought up to date.
+	 * @details Kept by the backends that simulate their own copy of the store,
+	 *          SimulationPipeline and GpuSimulation. Only which entities and fields
+	 *          changed is logged; the values are read from the main thread's store,
+	 *          which handle_input has written them to by the time they are applied.
+	 */
+	struct EditLog {
+		// InputChange flags and entity indices of edited entities, plus renamed
+		// entities and spawned or despawned slots
+		std::uint32_t changes = 0;
+		std::vector<std::uint32_t> edited;
+		std::vector<std::uint32_t> renamed;
+		std::vector<std::uint32_t> spawned;
+
+		/**
+		 * Logs the edits handle_input is about to make to the selected entities, and the frame's spawns.
+		 * @details Must be called before handle_input, which clears the change flags.
+		 *          Edits made in the same frame as a new selection are dropped, as
+		 *          handle_input drops them.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 */
+		void queue(const Input& input, const EntityStore& entities);
+
+		/**
+		 * Checks whether a field was edited.
+		 * @param change Field
+		 * @return true if the field was edited on the entities listed in edited
+		 */
+		bool changed(InputChange change) const { return (changes & static_cast<std::uint32_t>(change)) != 0; }
+
+		/**
+		 * Copies the logged fields, and spawned or despawned slots whole, to a copy of a store.
+		 * @details Spawns reuse a slot of the same shape type, so the copy's shape groups
+		 *          are unchanged; its active set is updated.
+		 * @param source Store the edits were made to
+		 * @param target Copy of the store, of the same size
+		 */
+		void apply(const EntityStore& source, EntityStore& target) const;
+
+		/**
+		 * Copies the logged velocities, and the positions and velocities of spawned or despawned slots.
+		 * @details For components simulated from a state older than the edits.
+		 * @param source Store holding the edited values
+		 * @param target Store to patch, of the same size
+		 */
+		void apply_motion(const EntityStore& source, EntityStore& target) const;
+
+		/**
+		 * Forgets every logged edit.
+		 */
+		void clear();
+	};
+
+	/**
+	 * Runs the simulation of the next frame on a worker thread while the current frame renders.
+	 * @details The worker steps its own copy of the entity store, then copies the
+	 *          simulated components into a second buffer. At each sync point, UI
+	 *          edits queued since the last one are applied to the worker's copy,
+	 *          and that buffer is swapped with the store the main thread renders
+	 *          and edits; the next step then starts from there. Rendered state
+	 *          therefore trails the simulation by one frame.
+	 */
+	class SimulationPipeline {
+	public:
+		SimulationPipeline() = default;
+
+		/**
+		 * Waits for the running step and stops the worker thread.
+		 */
+		~SimulationPipeline();
+
+		SimulationPipeline(const SimulationPipeline&) = delete;
+		SimulationPipeline& operator =(const SimulationPipeline&) = delete;
+
+		/**
+		 * Queues the edits handle_input is about to make to the selected entities.
+		 * @details Must be called before handle_input, which clears the change flags.
+		 *          Spawned and despawned slots are copied whole, and a replaced scene
+		 *          instead makes the next sync copy the whole store.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 */
+		void queue_edits(const Input& input, const EntityStore& entities);
+
+		/**
+		 * Waits for the running step, applies the queued edits to it, and publishes
+		 * its simulated positions and velocities.
+		 * @details Publishing swaps the component vectors, so only edited entities
+		 *          are copied. The first sync after starting or a replaced scene
+		 *          copies the whole store to the worker instead, publishing nothing.
+		 * @param entities Game entities, rendered and edited on the main thread
+		 */
+		void sync(EntityStore& entities);
+
+		/**
+		 * Starts simulating the next frame on the worker thread.
+		 * @param input Input data payload, of which the simulation settings are copied
+		 * @param world World bounds
+		 * @param frame_time Seconds elapsed since the last frame
+		 */
+		void start(const Input& input, const World& world, float frame_time);
+
+		/**
+		 * Waits for the running step and discards the worker's copy of the store.
+		 */
+		void stop();
+
+	private:
+		std::thread worker;
+		std::mutex mutex;
+		std::condition_variable condition;
+		// Guarded by mutex: a step has been started and not finished, or the worker should exit
+		bool is_pending = false;
+		bool is_stopping = false;
+		// Guarded by mutex: published holds the results of a step not yet swapped in
+		bool is_published = false;
+		// Whether state is a copy of the main thread's store (plus queued edits)
+		bool is_synced = false;
+		EntityStore state;
+		// Components of state copied by the worker after each step, so the main
+		// thread's store can take them by swapping
+		struct Published {
+			std::vector<float> position_x;
+			std::vector<float> position_y;
+			std::vector<float> previous_x;
+			std::vector<float> previous_y;
+			std::vector<float> velocity_x;
+			std::vector<float> velocity_y;
+			std::vector<float> render_x;
+			std::vector<float> render_y;
+		};
+		Published published;
+		SimulationClock clock;
+		CollisionGrid collision_grid;
+		// Only the simulation settings are copied, so the UI can keep editing the
+		// live Input while the worker runs
+		Input settings;
+		World world;
+		float frame_time = 0.0f;
+		// Edits queued since the last sync
+		EditLog edits;
+
+		/**
+		 * Worker thread loop, simulating one frame each time a step is started.
+		 */
+		void run();
+
+		/**
+		 * Waits until the running step, if any, has finished.
+		 */
+		void wait();
+	};
+
+	/**
+	 * Runs the simulation in an OpenGL 4.3 compute shader, keeping positions and velocities in GPU buffers.
+	 * @details One dispatch a frame integrates every active entity for all the ticks
+	 *          due, the same way move does, and writes the shape renderer's instance
+	 *          data at the interpolated positions into a buffer ShapeRenderer::draw_buffer
+	 *          draws from, so nothing makes a round trip through the CPU. Instances
+	 *          outside the view are collapsed to a point in place. Positions are
+	 *          only read back into the store where the CPU uses them: the selected
+	 *          entities every frame, in one copy of the range they span, and every
+	 *          entity while nametags are shown or a selection box is dragged.
+	 *          Collisions are not simulated.
+	 *          rlgl is built for OpenGL 3.3, so the 4.3 entry points are loaded
+	 *          here and loading fails on contexts without them.
+	 */
+	class GpuSimulation {
+	public:
+		// Invocations per work group, the shader's local_size_x
+		static constexpr std::size_t group_size = 256;
+
+		/**
+		 * Loads the compute shader.
+		 * @param cs_path Compute shader file path
+		 * @return true if the context supports compute shaders and the shader linked
+		 */
+		bool load(const std::filesystem::path& cs_path);
+
+		/**
+		 * Releases the shader and GPU buffers.
+		 */
+		void unload();
+
+		/**
+		 * Checks whether the compute shader is loaded.
+		 * @return true if the simulation can run on the GPU
+		 */
+		bool is_ready() const { return program != 0; }
+
+		/**
+		 * Checks whether the GPU buffers hold the scene, which then owns the positions and velocities.
+		 * @return true between the first step and stop
+		 */
+		bool is_running() const { return is_synced; }
+
+		/**
+		 * Queues the edits handle_input is about to make to the selected entities.
+		 * @details Must be called before handle_input, which clears the change flags.
+		 *          Spawned and despawned slots are uploaded whole, and a replaced scene
+		 *          instead makes the next step upload the whole store.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 */
+		void queue_edits(const Input& input, const EntityStore& entities);
+
+		/**
+		 * Uploads the scene or the queued edits, simulates the ticks due this frame,
+		 * and reads back the positions the CPU uses.
+		 * @param input Input data payload
+		 * @param world World bounds
+		 * @param view Visible world area, outside which instances are culled
+		 * @param entities Game entities
+		 * @param clock Fixed-timestep accumulator
+		 * @param frame_time Seconds elapsed since the last frame
+		 */
+		void step(const Input& input, const World& world, const AABB& view, EntityStore& entities, SimulationClock& clock, float frame_time);
+
+		/**
+		 * Reads every entity back into the store if its positions are older than the GPU's, and keeps simulating.
+		 * @details Call before anything reads or rebuilds from the whole store,
+		 *          since only the selection is read back while nametags are hidden.
+		 * @param entities Game entities
+		 */
+		void sync_to(EntityStore& entities);
+
+		/**
+		 * Reads every entity back into the store and hands it back to the CPU path.
+		 * @param entities Game entities
+		 */
+		void stop(EntityStore& entities);
+
+		/**
+		 * Gets the buffer of ShapeInstance records for the active entities.
+		 * @return Buffer ID
+		 */
+		unsigned int instance_buffer() const { return instance_ssbo; }
+
+		/**
+		 * Gets the number of records in the instance buffer.
+		 * @return Active entity count at the last upload
+		 */
+		std::size_t instance_count() const { return active_count; }
+
+		/**
+		 * Gets the size of the GPU buffers.
+		 * @return Allocated bytes
+		 */
+		std::size_t gpu_bytes() const;
+
+	private:
+		/**
+		 * Entity state in the shader's Body layout.
+		 */
+		struct Body {
+			float x = 0.0f;
+			float y = 0.0f;
+			float velocity_x = 0.0f;
+			float velocity_y = 0.0f;
+			float previous_x = 0.0f;
+			float previous_y = 0.0f;
+			float half_width = 0.0f;
+			float half_height = 0.0f;
+		};
+
+		/**
+		 * OpenGL entry points rlgl does not expose.
+		 */
+		struct Api {
+			void (*get_integer)(unsigned int name, int* value) = nullptr;
+			unsigned int (*create_program)() = nullptr;
+			void (*attach_shader)(unsigned int program, unsigned int shader) = nullptr;
+			void (*link_program)(unsigned int program) = nullptr;
+			void (*get_program)(unsigned int program, unsigned int name, int* value) = nullptr;
+			void (*delete_shader)(unsigned int shader) = nullptr;
+			void (*bind_buffer_base)(unsigned int target, unsigned int index, unsigned int buffer) = nullptr;
+			void (*get_buffer_sub_data)(unsigned int target, std::ptrdiff_t offset, std::ptrdiff_t size, void* data) = nullptr;
+			void (*dispatch_compute)(unsigned int x, unsigned int y, unsigned int z) = nullptr;
+			void (*memory_barrier)(unsigned int barriers) = nullptr;
+		};
+
+		Api gl;
+		unsigned int program = 0;
+		int active_count_location = -1;
+		int circle_count_location = -1;
+		int steps_location = -1;
+		int dt_location = -1;
+		int world_location = -1;
+		int gravity_location = -1;
+		int damping_location = -1;
+		int wrap_location = -1;
+		int reset_location = -1;
+		int alpha_location = -1;
+		int point_size_location = -1;
+		int view_location = -1;
+		// Bodies and colors by entity index; active entity indices and their
+		// instances in grouped order
+		unsigned int body_ssbo = 0;
+		unsigned int color_ssbo = 0;
+		unsigned int order_ssbo = 0;
+		unsigned int instance_ssbo = 0;
+		std::size_t capacity = 0;
+		std::size_t entity_count = 0;
+		std::size_t active_count = 0;
+		std::size_t circle_count = 0;
+		// Whether the buffers hold the scene, and whether the store's copy of the
+		// positions is older than the buffers'
+		bool is_synced = false;
+		bool is_stale = false;
+		float alpha = 1.0f;
+		// Edits queued since the last step
+		EditLog edits;
+		// Staging for uploads and read backs
+		std::vector<Body> bodies;
+		std::vector<std::uint32_t> words;
+
+		/**
+		 * Uploads the whole store, growing the buffers if needed.
+		 * @param entities Game entities
+		 */
+		void upload(const EntityStore& entities);
+
+		/**
+		 * Uploads the active entity indices in grouped order.
+		 * @param entities Game entities
+		 */
+		void upload_order(const EntityStore& entities);
+
+		/**
+		 * Reads every body back into the store.
+		 * @param entities Game entities
+		 */
+		void read_back(EntityStore& entities);
+
+		/**
+		 * Reads some bodies back into the store with one copy of the range they span.
+		 * @param entities Game entities
+		 * @param indices Entity indices
+		 */
+		void read_back(EntityStore& entities, const std::vector<std::uint32_t>& indices);
+
+		/**
+		 * Gets an entity's state in the shader's layout.
+		 * @param entities Game entities
+		 * @param i Entity index
+		 * @return Body to upload
+		 */
+		static Body make_body(const EntityStore& entities, std::size_t i);
+
+		/**
+		 * Writes a body's positions and velocity to an entity.
+		 * @param entities Game entities
+		 * @param i Entity index
+		 * @param body Body read back
+		 * @param alpha Fraction of a tick to interpolate the render position by
+		 */
+		static void store_body(EntityStore& entities, std::size_t i, const Body& body, float alpha);
+	};
+
+	/**
+	 * ImGui window with heap usage by subsystem and the memory held by the store and GPU buffers.
+	 * @details The heap figures come from the tracked global operator new, so they
+	 *          are only filled in with A1_MEMORY (make MEMORY=1). raylib allocates
+	 *          with malloc and is not tracked; its textures and buffers are
+	 *          estimated from their sizes instead.
+	 */
+	class MemoryPanel {
+	public:
+		/**
+		 * Number of GPU memory figures sampled each frame.
+		 */
+		static constexpr std::size_t gpu_part_count = 5;
+
+		/**
+		 * Samples the allocation counters and memory sizes at the end of a frame.
+		 * @param entities Game entities
+		 * @param font Font nametags are drawn with
+		 * @param shape_renderer Instanced shape renderer
+		 * @param text_renderer Instanced text renderer
+		 * @param scene_cache Offscreen copy of the scene
+		 * @param gpu_simulation Compute shader simulation
+		 */
+		void end_frame(const EntityStore& entities, const Font& font, const ShapeRenderer& shape_renderer, const TextRenderer& text_renderer, const SceneCache& scene_cache, const GpuSimulation& gpu_simulation);
+
+		/**
+		 * Provides an ImGui window with the last frame's sample and high-water marks.
+		 */
+		void draw_ui() const;
+
+	private:
+		// Allocation counts at the last sample, and the counts made during the frame before it
+		std::array<std::size_t, memory_tag_count> allocations{};
+		std::array<std::size_t, memory_tag_count> frame_allocations{};
+		std::size_t entity_count = 0;
+		StoreMemory store;
+		StoreMemory store_peak;
+		std::array<std::size_t, gpu_part_count> gpu{};
+		std::array<std::size_t, gpu_part_count> gpu_peak{};
+	};
+
+	/**
+	 * Records the input a session applies, for deterministic replay (see SessionHeader).
+	 * @details Captures the starting scene, then every frame the edits handle_input is
+	 *          about to apply, settings changes, and any scene replaced by reset or
+	 *          load. Frames without changes cost nothing but the frame count.
+	 */
+	class SessionRecorder {
+	public:
+		/**
+		 * Starts recording from the current scene, selection and settings.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 * @param world World bounds
+		 */
+		void begin(const Input& input, const EntityStore& entities, const World& world);
+
+		/**
+		 * Records a frame's changes; call every frame before handle_input.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 */
+		void record(const Input& input, const EntityStore& entities);
+
+		/**
+		 * Stops recording and writes the session.
+		 * @param path Output file path
+		 * @return true if the file was written
+		 */
+		bool end(const std::filesystem::path& path);
+
+		/**
+		 * Checks whether a recording is in progress.
+		 * @return true if recording
+		 */
+		bool is_recording() const { return recording; }
+
+		/**
+		 * Gets the number of frames recorded so far.
+		 * @return Frame count
+		 */
+		std::uint32_t frame_count() const { return header.frame_count; }
+
+	private:
+		SessionHeader header;
+		SessionSettings settings;
+		std::vector<char> initial_state;
+		std::vector<char> events;
+		// Snapshot of a replaced scene, reused between frames
+		std::vector<char> scene;
+		bool recording = false;
+
+		/**
+		 * Appends a frame record (see SessionHeader).
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 * @param flags Recorded flags
+		 */
+		void append_record(const Input& input, const EntityStore& entities, std::uint32_t flags);
+	};
+
+	/**
+	 * Replays a recorded session frame by frame (see SessionRecorder).
+	 */
+	class SessionPlayer {
+	public:
+		/**
+		 * Reads a session file and validates its header and starting scene.
+		 * @param path Session file path
+		 * @return true if the session can be replayed
+		 */
+		bool load(const std::filesystem::path& path);
+
+		/**
+		 * Restores the starting scene and rewinds to the first frame.
+		 * @param entities Game entities, replaced
+		 * @return true if the scene was restored
+		 */
+		bool restart(EntityStore& entities);
+
+		/**
+		 * Applies the next frame's records to the input and scene, marking the
+		 * changes for handle_input to apply.
+		 * @param input Input data payload
+		 * @param entities Game entities
+		 * @return false if a record is malformed
+		 */
+		bool apply(Input& input, EntityStore& entities);
+
+		/**
+		 * Gets the number of recorded frames.
+		 * @return Frame count
+		 */
+		std::uint32_t frame_count() const { return header.frame_count; }
+
+		/**
+		 * Gets the recorded world bounds.
+		 * @return World bounds
+		 */
+		World world() const { return { header.world_width, header.world_height }; }
+
+	private:
+		SessionHeader header;
+		std::vector<char> data;
+		// Offset of the next record in data, and the frame it is applied on
+		std::size_t next = 0;
+		std::uint32_t frame = 0;
+	};
+
+	/**
+	 * Starting scene replacing the config's entities, given on the command line.
+	 */
+	struct SceneSource {
+		// Snapshot file to load, unless empty
+		std::filesystem::path snapshot;
+		// Generate a scene with generator instead
+		bool generate = false;
+		GeneratorSettings generator;
+	};
+
+	/**
+	 * Loads the starting scene on a worker thread while the window comes up.
+	 * @details The worker reads the config's Window, World and Font lines first,
+	 *          as the window needs them, then rasterizes the nametag font for the
+	 *          main thread to upload. The entity lines are parsed batch_size lines
+	 *          at a time, and each batch is handed over as its own store, so the
+	 *          scene fills in over the first frames. A snapshot or generated scene
+	 *          replacing the config's entities arrives as a single batch.
+	 */
+	class SceneLoader {
+	public:
+		// Config lines parsed into each batch
+		static constexpr std::size_t batch_size = 16384;
+		// Batches the main thread takes per poll, bounding the time added to a frame
+		static constexpr std::size_t batches_per_poll = 4;
+
+		SceneLoader() = default;
+
+		/**
+		 * Stops the worker thread.
+		 */
+		~SceneLoader();
+
+		SceneLoader(const SceneLoader&) = delete;
+		SceneLoader& operator =(const SceneLoader&) = delete;
+
+		/**
+		 * Starts loading on the worker thread.
+		 * @param config_path Config file path
+		 * @param source Scene replacing the config's entities, if any
+		 * @param text_renderer Nametag renderer to prepare, not loaded, and left
+		 *        alone by the caller until take_font returns true
+		 */
+		void start(std::filesystem::path config_path, SceneSource source, TextRenderer& text_renderer);
+
+		/**
+		 * Waits until the config's Window, World and Font lines have been read.
+		 * @param config Game config, of which the window, world and font are set
+		 * @return false if the config could not be read (see error)
+		 */
+		bool wait_for_header(Config& config);
+
+		/**
+		 * Checks whether the nametag font has been prepared since the last call.
+		 * @return true once, after which the text renderer can be uploaded
+		 */
+		bool take_font();
+
+		/**
+		 * Appends the batches parsed since the last poll to the scene.
+		 * @details Takes at most batches_per_poll batches. The first batch is
+		 *          moved into an empty scene rather than copied.
+		 * @param templates Entity templates from the config
+		 * @param entities Game entities
+		 * @return Number of entities added
+		 */
+		std::size_t poll(EntityStore& templates, EntityStore& entities);
+
+		/**
+		 * Checks whether the worker is still parsing or batches are waiting to be taken.
+		 * @return true until the whole scene has been taken, or loading failed
+		 */
+		bool is_loading() const;
+
+		/**
+		 * Gets the reason loading failed.
+		 * @return Error message, or nullptr if loading has not failed
+		 */
+		const char* error() const;
+
+		/**
+		 * Gets the fraction of the config parsed so far.
+		 * @return Progress in [0, 1]
+		 */
+		float progress() const;
+
+		/**
+		 * Takes the watcher of the config file, holding the text the scene was loaded from.
+		 * @details Only valid once loading has finished.
+		 * @return Config watcher
+		 */
+		ConfigWatcher take_watcher() { return std::move(watcher); }
+
+		/**
+		 * Asks the worker to stop after its current batch and waits for it.
+		 */
+		void stop();
+
+	private:
+		std::thread worker;
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		// Guarded by mutex
+		bool has_header = false;
+		bool is_font_pending = false;
+		bool is_finished = false;
+		bool is_stopping = false;
+		const char* failure = nullptr;
+		Config header;
+		std::vector<EntityStore> batches;
+		std::size_t parsed_bytes = 0;
+		std::size_t total_bytes = 0;
+		// Only touched by the worker until is_finished is set
+		std::filesystem::path config_path;
+		SceneSource source;
+		TextRenderer* text_renderer = nullptr;
+		ConfigWatcher watcher;
+
+		/**
+		 * Worker thread body, loading the whole scene.
+		 */
+		void run();
+
+		/**
+		 * Hands a parsed batch to the main thread.
+		 * @param batch Parsed entities
+		 * @param bytes Bytes of the config parsed so far
+		 * @return false if the worker should stop
+		 */
+		bool publish(EntityStore&& batch, std::size_t bytes);
+
+		/**
+		 * Ends loading with an error.
+		 * @param message Error message
+		 */
+		void fail(const char* message);
+	};
+
+	/**
+	 * Velocity units per second equivalent to one unit per frame in config files.
+	 */
+	inline constexpr float reference_tick_rate = 60.0f;
+
+	/**
+	 * Settings for a headless benchmark run.
+	 */
+	struct BenchmarkOptions {
+		// Synthetic scene sizes, ignored when a config file is given
+		std::vector<std::size_t> entity_counts ={ 1000, 10000, 100000, 1000000 };
+		std::filesystem::path config_path;
+		// Recorded session (see SessionRecorder), replayed instead of a scene when given
+		std::filesystem::path replay_path;
+		std::size_t frames = 300;
+		std::size_t warmup_frames = 10;
+		bool render = false;
+		bool parallel = false;
+		bool collide = false;
+		MotionSettings motion;
+		int thread_count = 0;
+		bool json = false;
+		std::uint32_t seed = 1;
+	};
+
+	/**
+	 * Timings and allocation counts from one benchmark run.
+	 * @details Frame times are in milliseconds. Render times measure CPU-side
+	 *          submission to the offscreen target and stay zero unless rendering.
+	 */
+	struct BenchmarkResult {
+		std::size_t entities = 0;
+		std::size_t frames = 0;
+		double simulation_ns_per_entity = 0.0;
+		double simulation_p50_ms = 0.0;
+		double simulation_p99_ms = 0.0;
+		double render_p50_ms = 0.0;
+		double render_p99_ms = 0.0;
+		double allocations_per_frame = 0.0;
+	};
+
+	/**
+	 * Reads game config from an input stream.
+	 * @details Reads the rest of the stream and parses it with parse_config.
+	 * @param input Input stream
+	 * @param obj Game config
+	 * @return Input stream (for chaining)
+	 */
+	std::istream& operator >>(std::istream& input, Config& obj);
+
+	/**
+	 * Checks whether nametags are drawn this frame.
+	 * @details Nametags too small to read are hidden instead of drawn as smudges.
+	 * @param input Input data payload
+	 * @return true if nametags are enabled and large enough on screen
+	 */
+	bool are_nametags_shown(const Input& input);
+
+	/**
+	 * Updates input fields following selection of new entity.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void change_selection(Input& input, const EntityStore& entities);
+
+	/**
+	 * Captures the settings a session recording keeps.
+	 * @param input Input data payload
+	 * @return Session settings
+	 */
+	SessionSettings capture_settings(const Input& input);
+
+	/**
+	 * Counts heap allocations made through global operator new.
+	 * @details Only benchmark (A1_BENCH) and memory tracking (A1_MEMORY) builds
+	 *          replace operator new, so this is otherwise always 0.
+	 * @return Number of allocations since program start
+	 */
+	std::size_t count_allocations();
+
+	/**
+	 * Draws outlines around the selected entities inside the view and the selection box being dragged.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 * @param view Visible world area
+	 * @return Number of draw calls issued
+	 */
+	std::size_t draw_selection(const Input& input, const EntityStore& entities, const AABB& view);
+
+	/**
+	 * Measures the bounding box of an entity from its scaled half-extents.
+	 * @param entities Game entities
+	 * @param i Entity index
+	 * @return Axis aligned bounding box
+	 */
+	AABB entity_aabb(const EntityStore& entities, std::size_t i);
+
+	/**
+	 * Checks whether two boxes overlap.
+	 * @param a First box
+	 * @param b Second box
+	 * @return true if the boxes share any area or edge
+	 */
+	bool intersects(const AABB& a, const AABB& b);
+
+	/**
+	 * Picks the number of edge segments for a circle from its on-screen size.
+	 * @param radius Radius in screen pixels
+	 * @param lod Level of detail thresholds
+	 * @return Segment count, from 6 up to 96
+	 */
+	int circle_segments(float radius, const LevelOfDetail& lod);
+
+	/**
+	 * Separates two overlapping entities and exchanges momentum along the contact normal.
+	 * @details Circle/circle, rectangle/rectangle and circle/rectangle contacts are
+	 *          supported. Entities are treated as rigid discs or boxes with mass
+	 *          proportional to area, and collide perfectly elastically.
+	 * @param entities Game entities
+	 * @param a First entity index
+	 * @param b Second entity index
+	 * @return true if the entities were in contact
+	 */
+	bool collide(EntityStore& entities, std::uint32_t a, std::uint32_t b);
+
+	/**
+	 * Draws the names of all active entities inside the view with raylib.
+	 * @param input Input data payload (text size & color)
+	 * @param entities Game entities
+	 * @param font raylib font data
+	 * @param view Visible world area
+	 * @return Number of draw calls issued
+	 */
+	std::size_t draw_names(const Input& input, const EntityStore& entities, const Font& font, const AABB& view);
+
+	/**
+	 * Draws the shapes of all active entities inside the view with raylib.
+	 * @details Circles are tessellated with segments of about input.lod.segment_length
+	 *          pixels on screen, and drawn as squares below input.lod.point_size pixels.
+	 * @param input Input data payload (camera & level of detail)
+	 * @param entities Game entities
+	 * @param view Visible world area
+	 * @return Number of draw calls issued
+	 */
+	std::size_t draw_shapes(const Input& input, const EntityStore& entities, const AABB& view);
+
+	/**
+	 * Syncs input and game state.
+	 * @details Writes the fields marked as changed back to the selected entity and
+	 *          clears the marks. When a new entity is selected, the input fields are
+	 *          updated to reflect the new data instead.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void handle_input(Input& input, EntityStore& entities);
+
+	/**
+	 * Provides input fields for universal controls.
+	 * @param input Input data payload
+	 */
+	void handle_all_shape_controls_ui(Input& input);
+
+	/**
+	 * Renders current game state with raylib.
+	 * @details Entities whose bounds miss the view are culled before any draw
+	 *          call is issued, so off-screen entities cost a bounds test each.
+	 *          Instanced shape data is built across threads when input.parallel_enabled.
+	 * @param input Input data payload
+	 * @param font raylib font for entity nametags, used when the text renderer is not ready
+	 * @param font_asset Font asset for entity nametag size & color
+	 * @param entities Game entities
+	 * @param shape_renderer Instanced shape renderer, used when ready and enabled
+	 * @param text_renderer Distance field nametag renderer, used when ready
+	 * @param gpu_simulation Compute shader simulation, whose instance buffer is drawn while it runs
+	 * @param view Visible world area (see view_bounds)
+	 * @return Number of draw calls issued
+	 */
+	std::size_t handle_rendering(const Input& input, const Font& font, const FontAsset& font_asset, const EntityStore& entities, ShapeRenderer& shape_renderer, TextRenderer& text_renderer, const GpuSimulation& gpu_simulation, const AABB& view);
+
+	/**
+	 * Applies recorded session settings to the input.
+	 * @param settings Session settings
+	 * @param input Input data payload
+	 */
+	void apply_settings(const SessionSettings& settings, Input& input);
+
+	/**
+	 * Fills a store with randomly placed circles and rectangles.
+	 * @details Entities are placed fully inside the world where they fit, and named
+	 *          C or R followed by their index. Component arrays are written directly
+	 *          across threads; each entity's values come from a counter-based generator
+	 *          keyed by the seed and its index, so the same settings always give the
+	 *          same scene for any thread count. Names and shape groups are filled in
+	 *          a serial pass afterwards.
+	 * @param entities Game entities, cleared first
+	 * @param settings Entity count, distributions and seed
+	 * @param world World bounds
+	 * @param thread_count Maximum number of threads, or 0 for all available
+	 */
+	void generate_entities(EntityStore& entities, const GeneratorSettings& settings, const World& world, int thread_count);
+
+	/**
+	 * Provides button to reset all game state.
+	 * @param input Input data payload
+	 * @param initial_state Snapshot of the initial game entities (see write_snapshot)
+	 * @param entities Game entities
+	 * @param font_asset Font asset for entity nametag size & color
+	 * @param gpu_simulation GPU simulation backend, read back before saving
+	 * @details Also saves and loads the scene as a binary snapshot in the working directory.
+	 */
+	void handle_reset_ui(Input& input, std::string_view initial_state, EntityStore& entities, const FontAsset& font_asset, GpuSimulation& gpu_simulation);
+
+	/**
+	 * Provides input fields for the scene generator and a button replacing the scene with a generated one.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 * @param world World bounds
+	 */
+	void handle_generator_ui(Input& input, EntityStore& entities, const World& world);
+
+	/**
+	 * Provides input fields and a button to spawn copies of an entity template.
+	 * @details Copies share the template's position and speed, with directions
+	 *          fanned evenly around it. Spawning is applied by handle_spawning.
+	 * @param input Input data payload
+	 * @param templates Entity templates from the config
+	 */
+	void handle_spawn_ui(Input& input, const EntityStore& templates);
+
+	/**
+	 * Provides a button to start and stop recording the session.
+	 * @details Stopping writes the recording to session.a1r in the working directory,
+	 *          which the benchmark replays with --replay.
+	 * @param input Input data payload
+	 * @param recorder Session recorder
+	 * @param entities Game entities
+	 * @param world World bounds
+	 * @param gpu_simulation GPU simulation backend, read back before recording starts
+	 */
+	void handle_recording_ui(const Input& input, SessionRecorder& recorder, EntityStore& entities, const World& world, GpuSimulation& gpu_simulation);
+
+	/**
+	 * Provides a filterable entity list and input fields for the selected entities.
+	 * @details The list is clipped to its visible rows. Clicking selects one
+	 *          entity, Ctrl+click toggles and Shift+click selects a range of rows.
+	 *          Active, scale, velocity and color edits apply to the whole
+	 *          selection; name edits apply to the primary entity only.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void handle_selected_shape_ui(Input& input, EntityStore& entities);
+
+	/**
+	 * Selects entities by dragging a box over the world outside the UI.
+	 * @details A click without dragging selects the topmost entity under the
+	 *          cursor. Holding Shift adds to the selection instead of replacing it.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void handle_box_selection(Input& input, const EntityStore& entities);
+
+	/**
+	 * Pans and zooms the camera with the mouse outside the UI.
+	 * @details Dragging with the right or middle button pans, and the wheel zooms
+	 *          around the cursor. Marks the view as changed when the camera moves.
+	 * @param input Input data payload
+	 */
+	void handle_camera(Input& input);
+
+	/**
+	 * Applies changes to the config file to the live scene, without reloading assets.
+	 * @details Polls the watcher and applies the diff with reload_config. Reset then
+	 *          restores the updated config. A font file change is only logged, since
+	 *          the font is not reloaded.
+	 * @param input Input data payload
+	 * @param watcher Config file watcher
+	 * @param config Game config, whose entity templates are what Reset restores
+	 * @param entities Game entities
+	 * @param initial_state Snapshot of the initial game entities, rewritten on reload
+	 * @param gpu_simulation GPU simulation backend, read back before the reload rebuilds from the store
+	 */
+	void handle_config_reload(Input& input, ConfigWatcher& watcher, Config& config, EntityStore& entities, std::vector<char>& initial_state, GpuSimulation& gpu_simulation);
+
+	/**
+	 * Updates game physics simulation.
+	 * @details Advances the simulation in fixed ticks of 1 / input.tick_rate seconds
+	 *          for the elapsed frame time, running at most input.max_catch_up_steps
+	 *          ticks, then interpolates render positions between the last two ticks.
+	 * @param input Input data payload
+	 * @param world World bounds
+	 * @param entities Game entities
+	 * @param clock Fixed-timestep accumulator
+	 * @param collision_grid Broad phase for entity-entity collisions, used when enabled
+	 * @param frame_time Seconds elapsed since the last frame
+	 */
+	void handle_simulation(const Input& input, const World& world, EntityStore& entities, SimulationClock& clock, CollisionGrid& collision_grid, float frame_time);
+
+	/**
+	 * Applies the spawn and despawn requests made in the UI.
+	 * @details Despawns the selection, then spawns from the requested template
+	 *          and selects the new entities. The written slots are listed in
+	 *          Input::spawn_slots for the pipeline and GPU copies of the store.
+	 *          The GPU simulation is only stopped when spawning grows the store,
+	 *          as its positions are newer than the store's while it runs.
+	 * @param input Input data payload
+	 * @param templates Entity templates from the config
+	 * @param entities Game entities
+	 * @param gpu_simulation GPU simulation backend
+	 */
+	void handle_spawning(Input& input, const EntityStore& templates, EntityStore& entities, GpuSimulation& gpu_simulation);
+
+	/**
+	 * Takes the batches the scene loader parsed since the last frame.
+	 * @details Once the whole scene has been taken, writes the snapshot Reset
+	 *          restores and starts watching the config for edits.
+	 * @param input Input data payload
+	 * @param loader Scene loader
+	 * @param config Game config, whose entity templates are filled in
+	 * @param entities Game entities
+	 * @param initial_state Snapshot of the initial game entities (see write_snapshot)
+	 * @param watcher Config watcher, replaced by the loader's once loading finishes
+	 * @throws std::runtime_error if loading failed
+	 * @return true while the scene is still loading
+	 */
+	bool handle_scene_loading(Input& input, SceneLoader& loader, Config& config, EntityStore& entities, std::vector<char>& initial_state, ConfigWatcher& watcher);
+
+	/**
+	 * Shows the scene loader's progress in place of the controls.
+	 * @param loader Scene loader
+	 * @param entities Game entities
+	 */
+	void handle_loading_ui(const SceneLoader& loader, const EntityStore& entities);
+
+	/**
+	 * Provides input fields for nametag font size & color.
+	 * @param input Input data payload
+	 */
+	void handle_text_ui(Input& input);
+
+	/**
+	 * Interpolates render positions between the previous and current positions.
+	 * @param entities Game entities
+	 * @param alpha Interpolation factor, 0 for previous and 1 for current positions
+	 */
+	void interpolate_positions(EntityStore& entities, float alpha);
+
+	/**
+	 * Rebuilds the entity list indices matching the input's filter.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void filter_entities(Input& input, const EntityStore& entities);
+
+	/**
+	 * Populates input fields with initial values.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 * @param font_asset Font asset for entity nametag size & color
+	 */
+	void initialize_ui(Input& input, const EntityStore& entities, const FontAsset& font_asset);
+
+	/**
+	 * Measures the bounding box of an entity at its interpolated render position.
+	 * @param entities Game entities
+	 * @param i Entity index
+	 * @return Axis aligned bounding box
+	 */
+	AABB render_aabb(const EntityStore& entities, std::size_t i);
+
+	/**
+	 * Loads game configuration from the specified file path.
+	 * @param path Input file path
+	 * @throws std::runtime_error if file not read
+	 * @return Input stream (for chaining)
+*
+	 */
+	Config load_config(const std::filesystem::path& path);
+
+	/**
+	 * Replaces the contents of an entity store with a snapshot file.
+	 * @param path Snapshot file path
+	 * @param entities Game entities, unchanged if the snapshot is not valid
+	 * @return false if the file could not be read or is not a valid snapshot
+	 */
+	bool load_snapshot(const std::filesystem::path& path, EntityStore& entities);
+
+	/**
+	 * Integrates the active entities of a batch, one run of active entities at a time.
+	 * @details Runs of inactive entities are skipped instead of masked out.
+	 * @param batch Entity range to integrate
+	 * @param integrate Kernel variant
+	 * @param ranges Active index ranges in ascending order
+	 */
+	void integrate_active(const IntegrationBatch& batch, void (*integrate)(const IntegrationBatch& batch), const std::vector<IndexRange>& ranges);
+
+	/**
+	 * Integrates a batch of entities one at a time.
+	 * @details Used when no vector instruction set is available, and for the
+	 *          remainder of a batch which does not fill a whole vector. Each
+	 *          combination of features is a separate instantiation, so disabled
+	 *          features cost nothing in the loop.
+	 * @tparam Features MotionFeature flags
+	 * @param batch Entity range to integrate
+	 */
+	template<std::uint32_t Features>
+	void integrate_scalar(const IntegrationBatch& batch);
+
+	/**
+	 * Checks whether an active set is better integrated by a masked sweep of the whole store.
+	 * @details True when the active runs are on average shorter than the gaps a
+	 *          vector would span, so per-run calls and scalar remainders would cost
+	 *          more than masking the inactive lanes.
+	 * @param ranges Active index ranges
+	 * @param count Number of entities
+	 * @param lanes Kernel vector width
+	 * @return true to sweep every entity
+	 */
+	bool is_fragmented(const std::vector<IndexRange>& ranges, std::size_t count, std::size_t lanes);
+
+	/**
+	 * Creates an integration batch covering every entity in a store.
+	 * @param entities Game entities
+	 * @param world World bounds
+	 * @param dt Time step in seconds
+	 * @param motion Edge behaviour and forces
+	 * @return Integration batch
+	 */
+	IntegrationBatch make_integration_batch(EntityStore& entities, const World& world, float dt, const MotionSettings& motion);
+
+	/**
+	 * Moves all active entities, adjusting position and velocity.
+	 * @details If an entity shape collides with the world bounds, the velocity
+				vector is adjusted in the x and/or y direction so the shape will
+				bounce off the edge of the world, unless wrapping is enabled. The
+				kernel variant for the enabled features is picked once per call.
+	 * @param entities Game entities
+	 * @param world World bounds
+	 * @param dt Time step in seconds
+	 * @param motion Edge behaviour and forces
+	 */
+	void move(EntityStore& entities, const World& world, float dt, const MotionSettings& motion);
+
+	/**
+	 * Moves all active entities, splitting the store into chunks across threads.
+	 * @details Falls back to a serial move when the store is too small to give
+	 *          more than one chunk, so small scenes don't pay for fork/join.
+	 * @param entities Game entities
+	 * @param world World bounds
+	 * @param dt Time step in seconds
+	 * @param motion Edge behaviour and forces
+	 * @param thread_count Maximum number of threads, or 0 for all available
+	 * @param min_chunk_size Minimum number of entities per thread
+	 */
+	void move_parallel(EntityStore& entities, const World& world, float dt, const MotionSettings& motion, int thread_count, std::size_t min_chunk_size);
+
+	/**
+	 * Measures nametags whose extents are stale.
+	 * @details Nametags are measured once per distinct name. All of them are
+	 *          re-measured when the text size differs from the size they were
+	 *          last measured at; otherwise only newly interned names are measured.
+	 * @param entities Game entities
+	 * @param font raylib font data
+	 * @param text_size Text font size
+	 */
+	void measure_names(EntityStore& entities, const Font& font, float text_size);
+
+	/**
+	 * Gets the heap usage charged to a subsystem.
+	 * @param tag Subsystem
+	 * @return Live bytes, high-water mark and allocation count
+	 */
+	MemoryUsage memory_usage(MemoryTag tag);
+
+	/**
+	 * Reads benchmark settings from command line arguments.
+	 * @details Accepted arguments:
+	 *     - --entities [N,N,...] Synthetic scene sizes
+	 *     - --config [File] Benchmark a scene file instead of synthetic scenes
+	 *     - --frames [N] Measured frames per scene
+	 *     - --warmup [N] Unmeasured frames per scene
+	 *     - --render Also render each frame to an offscreen texture
+	 *     - --parallel Use the parallel simulation mode
+	 *     - --collide Enable entity-entity collisions
+	 *     - --wrap Wrap shapes around the world edges instead of bouncing
+	 *     - --gravity [N] Downward acceleration in pixels per second squared
+	 *     - --damping [N] Velocity decay rate per second
+	 *     - --threads [N] Thread count for --parallel
+	 *     - --seed [N] Synthetic scene seed
+	 *     - --json Write JSON instead of CSV
+	 * @param argc Argument count
+	 * @param argv Argument values
+	 * @param options Benchmark settings
+	 * @return false if an argument was not understood
+	 */
+	bool parse_benchmark_options(int argc, char* argv[], BenchmarkOptions& options);
+
+	/**
+	 * Parses a whole command line value as a decimal integer.
+	 * @param text Argument value
+	 * @param value Parsed value, unchanged unless parsing succeeds
+	 * @return false if the text is not entirely a number in the range of T
+	 * @details An unsigned T rejects a leading minus sign rather than wrapping it.
+	 */
+	template<typename T>
+	bool parse_argument(std::string_view text, T& value);
+
+	/**
+	 * Packs a color into RGBA8, red in the lowest byte.
+	 * @param color Floating point color
+	 * @return Packed color
+	 */
+	std::uint32_t pack_color(Color color);
+
+	/**
+	 * Matches an entity name against a list filter.
+	 * @details Patterns containing * or ? must match the whole name, with * for
+	 *          any run of characters and ? for any one character. Other patterns
+	 *          match anywhere in the name, and an empty pattern matches every name.
+	 *          Matching ignores case.
+	 * @param name Entity name
+	 * @param pattern Filter pattern
+	 * @return true if the name matches
+	 */
+	bool matches_name(std::string_view name, std::string_view pattern);
+
+	/**
+	 * Parses game config text directly into a config's entity store.
+	 * @details Tokens are separated by whitespace, and each line may contain one
+	 *          of the following, in any order:
+	 *     - Window [Caption] [Width] [Height]
+	 *     - World [Width] [Height]
+	 *     - Font [File] [Size] [Red] [Green] [Blue]
+	 *     - Rectangle [Name] [X] [Y] [X Velocity] [Y Velocity] [Red] [Green] [Blue] [Width] [Height]
+	 *     - Circle [Name] [X] [Y] [X Velocity] [Y Velocity] [Red] [Green] [Blue] [Radius]
+	 *          Velocities are in pixels per frame at reference_tick_rate. Without a
+	 *          World line the world is the size of the window.
+	 *          Unknown tokens are skipped, and an entry cut short by the end of the
+	 *          text is dropped. The entity store is sized once from the line count.
+	 * @param text Config text
+	 * @param obj Game config
+	 * @return false if a value could not be parsed
+	 */
+	bool parse_config(std::string_view text, Config& obj);
+
+	/**
+	 * Parses only the Window, World and Font lines of a config.
+	 * @details Entity lines are skipped without reading their values, so the
+	 *          window can be created before the entities are parsed.
+	 * @param text Config text
+	 * @param obj Game config, of which the entity templates are left empty
+	 * @return false if a value could not be parsed
+	 */
+	bool parse_config_header(std::string_view text, Config& obj);
+
+	/**
+	 * Applies the difference between two versions of the config text to a config and the live scene.
+	 * @details Lines are compared as whole strings after skipping the lines both texts
+	 *          start and end with, and only lines not found in the previous text are parsed. Their entities are matched by name with the
+	 *          config's entity templates and the live entities: only values that
+	 *          differ from the template are written, so unchanged fields keep
+	 *          simulating. Unmatched entities are added, and entities whose line was
+	 *          removed are deactivated. With duplicate names, the first entity wins.
+	 *          Without a World line, the world follows edits to the window size.
+	 * @param previous Config text the config and scene were built from
+	 * @param current New config text
+	 * @param config Game config, updated to match the new text
+	 * @param entities Game entities
+	 * @param changes Summary of what changed (output)
+	 * @return false if the changed lines could not be parsed, changing nothing
+	 */
+	bool reload_config(std::string_view previous, std::string_view current, Config& config, EntityStore& entities, ConfigChanges& changes);
+
+	/**
+	 * Replaces the contents of an entity store with a snapshot in memory.
+	 * @details Component arrays are copied in bulk into the store's existing
+	 *          storage, so restoring a scene no larger than the store allocates
+	 *          nothing. Only the shape groups and names are rebuilt per entity;
+	 *          entities whose name is unchanged keep their measured nametag.
+	 * @param data Snapshot bytes, as written by write_snapshot
+	 * @param entities Game entities, unchanged if the snapshot is not valid
+	 * @return false if the data is not a valid snapshot
+	 */
+	bool restore_snapshot(std::string_view data, EntityStore& entities);
+
+	/**
+	 * Benchmarks simulation, and optionally rendering, of a scene.
+	 * @details When replaying, the session's records are applied through handle_input
+	 *          at the start of each frame, and its settings replace the options'.
+	 * @param options Benchmark settings
+	 * @param world World bounds
+	 * @param entities Game entities, simulated in place
+	 * @param font raylib font for entity nametags, used when rendering
+	 * @param shape_renderer Instanced shape renderer, used when rendering
+	 * @param text_renderer Distance field nametag renderer, used when rendering if ready
+	 * @param target Offscreen render target, used when rendering, viewing the world from its origin
+	 * @param replay Session replayed from its first frame, or nullptr
+	 * @return Benchmark result
+	 */
+	BenchmarkResult run_benchmark(const BenchmarkOptions& options, const World& world, EntityStore& entities, const Font& font, ShapeRenderer& shape_renderer, TextRenderer& text_renderer, const RenderTexture2D& target, SessionPlayer* replay);
+
+	/**
+	 * Runs the headless benchmark program.
+	 * @param argc Argument count
+	 * @param argv Argument values
+	 * @return Process exit code
+	 */
+	int run_benchmarks(int argc, char* argv[]);
+
+	/**
+	 * Saves the current state of an entity store to a snapshot file.
+	 * @param entities Game entities
+	 * @param path Snapshot file path
+	 * @return false if the file could not be written
+	 */
+	bool save_snapshot(const EntityStore& entities, const std::filesystem::path& path);
+
+	/**
+	 * Picks the widest integration kernel supported by the running CPU.
+	 * @return Integration kernel
+	 */
+	IntegrationKernel select_integration_kernel();
+
+	/**
+	 * Resets the selection to the first entity, e.g. after the scene is replaced.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void reset_selection(Input& input, const EntityStore& entities);
+
+	/**
+	 * Selects an entity, making it the primary entity.
+	 * @param input Input data payload
+	 * @param handle Entity handle
+	 * @param extend Add to the selection rather than replacing it
+	 */
+	void select_entity(Input& input, EntityHandle handle, bool extend);
+
+	/**
+	 * Allocates a heap block charged to the current MemoryScope's subsystem.
+	 * @details The block is preceded by a header recording its size and tag, so
+	 *          freeing it credits the subsystem that allocated it.
+	 * @param size Number of bytes
+	 * @return Block aligned like malloc, or nullptr if out of memory
+	 */
+	void* tracked_allocate(std::size_t size);
+
+	/**
+	 * Frees a block from tracked_allocate.
+	 * @param block Block, or nullptr
+	 */
+	void tracked_free(void* block) noexcept;
+
+	/**
+	 * Updates selected entities & corresponding input fields.
+	 * @details Each field marked as changed is written across the selection in one
+	 *          pass; the velocity fields otherwise follow the primary entity's
+	 *          simulated velocity. Name edits only rename the primary entity.
+	 * @param input Input data payload
+	 * @param entities Game entities
+	 */
+	void update_selection(Input& input, EntityStore& entities);
+
+	/**
+	 * Gets the area of the world visible through a camera.
+	 * @param camera World view
+	 * @param width Screen width
+	 * @param height Screen height
+	 * @return Visible world area
+	 */
+	AABB view_bounds(const Camera2D& camera, float width, float height);
+
+	/**
+	 * Writes benchmark results as CSV or JSON.
+	 * @param output Output stream
+	 * @param results Benchmark results
+	 * @param kernel Integration kernel name
+	 * @param json true for JSON, false for CSV
+	 */
+	void write_benchmark_results(std::ostream& output, const std::vector<BenchmarkResult>& results, std::string_view kernel, bool json);
+
+	/**
+	 * Serializes an entity store into the binary snapshot format (see SnapshotHeader).
+	 * @param entities Game entities
+	 * @param buffer Output bytes, replaced
+	 */
+	void write_snapshot(const EntityStore& entities, std::vector<char>& buffer);
+}
+
+#if defined(A1_BENCH)
+//------------------------------------------------------------------------------------
+// Benchmark main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+	return a1::run_benchmarks(argc, argv);
+}
+#else
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char* argv[]) {
+	// Initialization
+	//--------------------------------------------------------------------------------------
+	const auto input_path = std::filesystem::path{ "assets/input.txt" };
+	// An optional snapshot argument, or --generate Count [Seed], replaces the
+	// config's entities (and what Reset restores)
+	auto source = a1::SceneSource{};
+	if( argc > 1 && std::string_view{ argv[1] } == "--generate" ) {
+		source.generate = true;
+		const auto is_valid = argc > 2 && argc < 5
+			&& a1::parse_argument(argv[2], source.generator.count) && source.generator.count > 0
+			&& (argc < 4 || a1::parse_argument(argv[3], source.generator.seed));
+		if( !is_valid ) {
+			std::cerr << "Usage: " << argv[0] << " [Snapshot | --generate Count [Seed]]\n";
+			return 1;
+		}
+	}
+	else if( argc > 1 ) {
+		source.snapshot = argv[1];
+	}
+	// The scene and the nametag font load on a worker thread; only the window
+	// settings are waited for
+	auto text_renderer = a1::TextRenderer{};
+	auto loader = a1::SceneLoader{};
+	loader.start(input_path, source, text_renderer);
+	auto config = a1::Config{};
+	if( !loader.wait_for_header(config) ) {
+		throw std::runtime_error(loader.error());
+	}
+	auto& [window, world, has_world, font_asset, entity_templates] = config;
+	// Reset restores this flat copy of the initial state in place, written once loaded
+	auto initial_state = std::vector<char>{};
+	// The templates are kept so edits to the config file can be diffed against them
+	auto entities = a1::EntityStore{};
+	auto config_watcher = a1::ConfigWatcher{};
+	auto is_loading = true;
+
+	SetConfigFlags(FLAG_WINDOW_HIGHDPI);
+	InitWindow(window.width, window.height, window.caption.c_str());
+
+#if defined(A1_MEMORY)
+	// ImGui allocates through its own hooks rather than operator new; they are
+	// set before its context is created and charge everything to the UI
+	ImGui::SetAllocatorFunctions(
+		[](std::size_t size, void*) {
+			A1_MEMORY_SCOPE(a1::MemoryTag::ui);
+			return a1::tracked_allocate(size);
+		},
+		[](void* block, void*) { a1::tracked_free(block); });
+#endif
+	//initialize the raylib ImGui backend
+	rlImGuiSetup(true);
+	//increase ImGui item size to 2x
+	ImGui::GetStyle().ScaleAllSizes(2);
+
+	// Set raylib to target 60 frames-per-second (this does not mean it will actually RUN at 60 fps)
+	SetTargetFPS(60);
+
+	// General variables
+	//--------------------------------------------------------------------------------------
+	auto input = a1::Input{};
+	auto clock = a1::SimulationClock{};
+	auto collision_grid = a1::CollisionGrid{};
+	auto pipeline = a1::SimulationPipeline{};
+	auto recorder = a1::SessionRecorder{};
+	auto shape_renderer = a1::ShapeRenderer{};
+	shape_renderer.load("assets/shaders/shapes.vs", "assets/shaders/shapes.fs");
+	// Nametags are measured with the font they are drawn with, set once the
+	// loader has prepared it
+	auto font = Font{};
+	auto scene_cache = a1::SceneCache{};
+	auto gpu_simulation = a1::GpuSimulation{};
+	input.gpu_available = gpu_simulation.load("assets/shaders/simulate.cs");
+#if defined(A1_PROFILE)
+	auto profiler = a1::Profiler{};
+#endif
+#if defined(A1_MEMORY)
+	auto memory_panel = a1::MemoryPanel{};
+#endif
+
+	initialize_ui(input, entities, font_asset);
+
+	// Main game loop
+	//--------------------------------------------------------------------------------------
+	// Detect window close button or ESC key
+	while( !WindowShouldClose() ) {
+		auto draw_calls = std::size_t{ 0 };
+#if defined(A1_PROFILE)
+		profiler.begin_frame();
+#endif
+
+		// Update
+		//----------------------------------------------------------------------------------
+		{
+			A1_PROFILE_SCOPE(profiler, a1::ProfilePhase::input);
+			if( is_loading ) {
+				is_loading = handle_scene_loading(input, loader, config, entities, initial_state, config_watcher);
+			}
+			if( loader.take_font() ) {
+				// Falls back to raylib's bitmap font when the distance field atlas could not be built
+				text_renderer.upload("assets/shaders/text.vs", "assets/shaders/text.fs");
+				font = text_renderer.is_ready() ? text_renderer.font() : LoadFont(font_asset.file.string().c_str());
+			}
+			handle_config_reload(input, config_watcher, config, entities, initial_state, gpu_simulation);
+			handle_camera(input);
+			handle_box_selection(input, entities);
+			handle_spawning(input, config.entity_templates, entities, gpu_simulation);
+			// Any edit since the last frame, or a running simulation, outdates the cached scene
+			if( input.changes != 0 || input.is_box_selecting || input.simulate_enabled || !input.scene_cache_enabled ) {
+				scene_cache.invalidate();
+			}
+			if( input.pipeline_enabled ) {
+				pipeline.queue_edits(input, entities);
+			}
+			if( input.gpu_enabled ) {
+				gpu_simulation.queue_edits(input, entities);
+			}
+			recorder.record(input, entities);
+			handle_input(input, entities);
+			if( font.texture.id != 0 ) {
+				a1::measure_names(entities, font, input.text_size);
+			}
+		}
+		{
+			A1_PROFILE_SCOPE(profiler, a1::ProfilePhase::simulation);
+			A1_MEMORY_SCOPE(a1::MemoryTag::simulation);
+			if( input.gpu_enabled && !input.collide_enabled && gpu_simulation.is_ready() ) {
+				pipeline.stop();
+				const auto view = a1::view_bounds(input.camera, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight()));
+				gpu_simulation.step(input, world, view, entities, clock, GetFrameTime());
+			}
+			else if( input.pipeline_enabled ) {
+				// The next frame simulates on the worker while this one renders
+				gpu_simulation.stop(entities);
+				pipeline.sync(entities);
+				pipeline.start(input, world, GetFrameTime());
+			}
+			else {
+				gpu_simulation.stop(entities);
+				pipeline.stop();
+				handle_simulation(input, world, entities, clock, collision_grid, GetFrameTime());
+			}
+		}
+
+		// Draw
+		//----------------------------------------------------------------------------------
+		BeginDrawing();
+
+		ClearBackground(BLACK);
+
+		//********** Raylib Drawing Content **********
+		{
+			A1_PROFILE_SCOPE(profiler, a1::ProfilePhase::rendering);
+			A1_MEMORY_SCOPE(a1::MemoryTag::rendering);
+			const auto view = a1::view_bounds(input.camera, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight()));
+			if( input.scene_cache_enabled && !input.simulate_enabled ) {
+				// A paused scene is only recorded again when something changed
+				if( !scene_cache.is_valid() ) {
+					scene_cache.begin(GetScreenWidth(), GetScreenHeight());
+					BeginMode2D(input.camera);
+					draw_calls = handle_rendering(input, font, font_asset, entities, shape_renderer, text_renderer, gpu_simulation, view);
+					EndMode2D();
+					scene_cache.end();
+				}
+				draw_calls += scene_cache.draw();
+			}
+			else {
+				BeginMode2D(input.camera);
+				draw_calls = handle_rendering(input, font, font_asset, entities, shape_renderer, text_renderer, gpu_simulation, view);
+				EndMode2D();
+			}
+#if defined(A1_PROFILE)
+			// Flush raylib's batch so the GPU submission is counted here, not in the UI phase
+			rlDrawRenderBatchActive();
+#endif
+		}
+
+		//********** ImGUI Content *********
+		{
+			A1_PROFILE_SCOPE(profiler, a1::ProfilePhase::ui);
+			A1_MEMORY_SCOPE(a1::MemoryTag::ui);
+			rlImGuiBegin();
+			ImGui::SetNextWindowSize(ImVec2(400, 780));
+			ImGui::Begin("Assignment 1 Controls", NULL, ImGuiWindowFlags_NoResize|ImGuiWindowFlags_NoCollapse);
+			if( is_loading ) {
+				handle_loading_ui(loader, entities);
+			}
+			else {
+				handle_all_shape_controls_ui(input);
+				handle_selected_shape_ui(input, entities);
+				handle_text_ui(input);
+				handle_reset_ui(input, { initial_state.data(), initial_state.size() }, entities, font_asset, gpu_simulation);
+				handle_generator_ui(input, entities, world);
+				handle_spawn_ui(input, config.entity_templates);
+				handle_recording_ui(input, recorder, entities, world, gpu_simulation);
+			}
+			ImGui::End();
+#if defined(A1_PROFILE)
+			profiler.draw_ui();
+#endif
+#if defined(A1_MEMORY)
+			memory_panel.draw_ui();
+#endif
+			rlImGuiEnd();
+		}
+
+		{
+			// Includes the buffer swap and raylib's wait for the target frame rate
+			A1_PROFILE_SCOPE(profiler, a1::ProfilePhase::present);
+			EndDrawing();
+		}
+		//----------------------------------------------------------------------------------
+#if defined(A1_PROFILE)
+		profiler.end_frame(entities.size(), draw_calls);
+#endif
+#if defined(A1_MEMORY)
+		memory_panel.end_frame(entities, font, shape_renderer, text_renderer, scene_cache, gpu_simulation);
+#endif
+	}
+
+	// Clean Up
+	//--------------------------------------------------------------------------------------
+	loader.stop();        // Stop loading before the text renderer it prepares is unloaded
+	rlImGuiShutdown();    // Shuts down the raylib ImGui backend
+	shape_renderer.unload(); // Remove shape shader & buffers from GPU memory
+	scene_cache.unload();  // Remove cached scene from GPU memory
+	gpu_simulation.unload(); // Remove compute shader & simulation buffers from GPU memory
+	if( !text_renderer.is_ready() && font.texture.id != 0 ) {
+		UnloadFont(font);     // Remove font from memory
+	}
+	text_renderer.unload(); // Remove glyph atlas, text shader & buffers from GPU memory
+	CloseWindow();        // Close window and OpenGL context
+	//--------------------------------------------------------------------------------------
+
+	return 0;
+}
+#endif
+
+#if defined(A1_BENCH) || defined(A1_MEMORY)
+void* operator new(std::size_t size) {
+	if( void* block = a1::tracked_allocate(size) ) {
+		return block;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* block) noexcept {
+	a1::tracked_free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+	a1::tracked_free(block);
+}
+#endif
+
+namespace a1 {
+	AABB Circle::aabb(Position position, float scale) const {
+		return {
+			position.x - radius * scale,
+			position.y - radius * scale,
+			2 * radius * scale,
+			2 * radius * scale
+		};
+	}
+
+	void Circle::draw(Position position, float scale, Color color) const {
+		DrawCircle(
+			static_cast<int>(position.x),
+			static_cast<int>(position.y),
+			radius * scale,
+			ColorFromNormalized({ color.r, color.g, color.b, color.a })
+		);
+	}
+
+	AABB Rectangle::aabb(Position position, float scale) const {
+		return {
+			position.x - width * scale / 2,
+			position.y - height * scale / 2,
+			width * scale,
+			height * scale
+		};
+	}
+
+	void Circle::draw(Position position, float scale, Color color, int segments) const {
+		DrawCircleSector(
+			{ position.x, position.y },
+			radius * scale,
+			0.0f,
+			360.0f,
+			segments,
+			ColorFromNormalized({ color.r, color.g, color.b, color.a })
+		);
+	}
+
+	void Rectangle::draw(Position position, float scale, Color color) const {
+		DrawRectangle(
+			static_cast<int>(position.x - width * scale / 2),
+			static_cast<int>(position.y - height * scale / 2),
+			static_cast<int>(width * scale),
+			static_cast<int>(height * scale),
+			ColorFromNormalized({ color.r, color.g, color.b, color.a })
+		);
+	}
+
+	EntityHandle EntityStore::add(std::string_view name, Position position, Velocity velocity, const Shape& shape, float scale, Color color, bool is_active) {
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		const auto handle = EntityHandle{ static_cast<std::uint32_t>(names.size()) };
+		names.push_back(intern_name(name));
+		position_x.push_back(position.x);
+		position_y.push_back(position.y);
+		previous_x.push_back(position.x);
+		previous_y.push_back(position.y);
+		render_x.push_back(position.x);
+		render_y.push_back(position.y);
+		velocity_x.push_back(velocity.x);
+		velocity_y.push_back(velocity.y);
+		scales.push_back(scale);
+		colors.push_back(color);
+		if( const auto* circle = std::get_if<Circle>(&shape) ) {
+			shape_types.push_back(ShapeType::circle);
+			extent_x.push_back(circle->radius);
+			extent_y.push_back(circle->radius);
+		}
+		else {
+			const auto& rectangle = std::get<Rectangle>(shape);
+			shape_types.push_back(ShapeType::rectangle);
+			extent_x.push_back(rectangle.width / 2);
+			extent_y.push_back(rectangle.height / 2);
+		}
+		shape_groups[static_cast<std::size_t>(shape_types.back())].push_back(handle.index);
+		this->is_active.push_back(is_active);
+		generations.push_back(0);
+		if( is_active ) {
+			// The new index is the largest, so appending keeps the lists sorted
+			active_groups[static_cast<std::size_t>(shape_types.back())].push_back(handle.index);
+			if( !active_ranges.empty() && active_ranges.back().end == handle.index ) {
+				++active_ranges.back().end;
+			}
+			else {
+				active_ranges.push_back({ handle.index, handle.index + 1 });
+			}
+		}
+		return handle;
+	}
+
+	void EntityStore::append(const EntityStore& other) {
+		for( std::size_t i = 0; i < other.size(); ++i ) {
+			if( other.is_alive(i) ) {
+				const auto position = Position{ other.position_x[i], other.position_y[i] };
+				const auto velocity = Velocity{ other.velocity_x[i], other.velocity_y[i] };
+				add(other.name_table.view(other.names[i]), position, velocity, other.shape(i), other.scales[i], other.colors[i], other.is_active[i] != 0);
+			}
+		}
+	}
+
+	EntityHandle EntityStore::spawn(std::string_view name, Position position, Velocity velocity, const Shape& shape, float scale, Color color, bool is_active) {
+		auto& slots = free_slots[static_cast<std::size_t>(std::holds_alternative<Circle>(shape) ? ShapeType::circle : ShapeType::rectangle)];
+		if( slots.empty() ) {
+			return add(name, position, velocity, shape, scale, color, is_active);
+		}
+		const auto i = slots.back();
+		slots.pop_back();
+		++generations[i];
+		names[i] = intern_name(name);
+		position_x[i] = previous_x[i] = render_x[i] = position.x;
+		position_y[i] = previous_y[i] = render_y[i] = position.y;
+		velocity_x[i] = velocity.x;
+		velocity_y[i] = velocity.y;
+		scales[i] = scale;
+		colors[i] = color;
+		// The slot already has this shape type, so only its extents change
+		reshape({ i }, shape);
+		this->is_active[i] = is_active;
+		return handle(i);
+	}
+
+	bool EntityStore::despawn(EntityHandle handle) {
+		if( !contains(handle) ) {
+			return false;
+		}
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		const auto i = handle.index;
+		++generations[i];
+		is_active[i] = 0;
+		free_slots[static_cast<std::size_t>(shape_types[i])].push_back(i);
+		return true;
+	}
+
+	std::size_t EntityStore::active_count() const {
+		auto count = std::size_t{ 0 };
+		for( const auto& group : active_groups ) {
+			count += group.size();
+		}
+		return count;
+	}
+
+	void EntityStore::clear() {
+		names.clear();
+		name_table.clear();
+		position_x.clear();
+		position_y.clear();
+		previous_x.clear();
+		previous_y.clear();
+		render_x.clear();
+		render_y.clear();
+		velocity_x.clear();
+		velocity_y.clear();
+		scales.clear();
+		colors.clear();
+		shape_types.clear();
+		extent_x.clear();
+		extent_y.clear();
+		is_active.clear();
+		generations.clear();
+		for( auto& group : shape_groups ) {
+			group.clear();
+		}
+		for( auto& slots : free_slots ) {
+			slots.clear();
+		}
+		for( auto& group : active_groups ) {
+			group.clear();
+		}
+		active_ranges.clear();
+		name_width.clear();
+		name_height.clear();
+		stale_names.clear();
+	}
+
+	NameId EntityStore::intern_name(std::string_view name) {
+		A1_MEMORY_SCOPE(MemoryTag::names);
+		const auto id = name_table.intern(name);
+		if( id == name_width.size() ) {
+			name_width.push_back(0.0f);
+			name_height.push_back(0.0f);
+			stale_names.push_back(id);
+		}
+		return id;
+	}
+
+	void EntityStore::rename(EntityHandle handle, std::string_view name) {
+		// The old name stays in the table until the store is cleared or restored
+		if( name_table.view(names[handle.index]) != name ) {
+			names[handle.index] = intern_name(name);
+		}
+	}
+
+	void EntityStore::reshape(EntityHandle handle, const Shape& shape) {
+		const auto i = handle.index;
+		const auto type = std::holds_alternative<Circle>(shape) ? ShapeType::circle : ShapeType::rectangle;
+		if( const auto* circle = std::get_if<Circle>(&shape) ) {
+			extent_x[i] = extent_y[i] = circle->radius;
+		}
+		else {
+			const auto& rectangle = std::get<Rectangle>(shape);
+			extent_x[i] = rectangle.width / 2;
+			extent_y[i] = rectangle.height / 2;
+		}
+		if( type == shape_types[i] ) {
+			return;
+		}
+		// Groups stay sorted so drawing order within a type is insertion order
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		const auto move_index = [&](auto& groups) {
+			auto& from = groups[static_cast<std::size_t>(shape_types[i])];
+			from.erase(std::lower_bound(from.begin(), from.end(), i));
+			auto& to = groups[static_cast<std::size_t>(type)];
+			to.insert(std::lower_bound(to.begin(), to.end(), i), i);
+		};
+		move_index(shape_groups);
+		if( is_active[i] ) {
+			move_index(active_groups);
+		}
+		shape_types[i] = type;
+	}
+
+	Shape EntityStore::shape(std::size_t i) const {
+		if( shape_types[i] == ShapeType::circle ) {
+			return Circle{ extent_x[i] };
+		}
+		return Rectangle{ 2 * extent_x[i], 2 * extent_y[i] };
+	}
+
+	std::size_t EntityStore::live_count() const {
+		auto count = size();
+		for( const auto& slots : free_slots ) {
+			count -= slots.size();
+		}
+		return count;
+	}
+
+	StoreMemory EntityStore::memory() const {
+		const auto bytes = [](const auto&... arrays) {
+			return ((arrays.capacity() * sizeof(typename std::decay_t<decltype(arrays)>::value_type)) + ...);
+		};
+		auto usage = StoreMemory{};
+		usage.components = bytes(position_x, position_y, previous_x, previous_y, render_x, render_y, velocity_x, velocity_y, scales, colors, is_active, generations);
+		usage.shapes = bytes(shape_types, extent_x, extent_y, active_ranges);
+		for( std::size_t type = 0; type < shape_type_count; ++type ) {
+			usage.shapes += bytes(shape_groups[type], active_groups[type], free_slots[type]);
+		}
+		usage.names = bytes(names, name_width, name_height, stale_names) + name_table.capacity_bytes();
+		return usage;
+	}
+
+	void EntityStore::reserve(std::size_t count, std::size_t name_characters) {
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		names.reserve(count);
+		name_table.reserve(count, name_characters);
+		position_x.reserve(count);
+		position_y.reserve(count);
+		previous_x.reserve(count);
+		previous_y.reserve(count);
+		render_x.reserve(count);
+		render_y.reserve(count);
+		velocity_x.reserve(count);
+		velocity_y.reserve(count);
+		scales.reserve(count);
+		colors.reserve(count);
+		shape_types.reserve(count);
+		extent_x.reserve(count);
+		extent_y.reserve(count);
+		is_active.reserve(count);
+		generations.reserve(count);
+		// Either group may hold every entity, so each is sized for all of them
+		for( auto& group : shape_groups ) {
+			group.reserve(count);
+		}
+		for( auto& group : active_groups ) {
+			group.reserve(count);
+		}
+		name_width.reserve(count);
+		name_height.reserve(count);
+		stale_names.reserve(count);
+	}
+
+	void EntityStore::update_active_set() {
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		const auto count = static_cast<std::uint32_t>(size());
+		active_ranges.clear();
+		for( std::uint32_t i = 0; i < count; ) {
+			if( !is_active[i] ) {
+				++i;
+				continue;
+			}
+			const auto begin = i;
+			while( i < count && is_active[i] ) {
+				++i;
+			}
+			active_ranges.push_back({ begin, i });
+		}
+		// Every index is written and the length only advances past active ones,
+		// so the lists are packed without a branch per entity
+		for( std::size_t type = 0; type < shape_type_count; ++type ) {
+			const auto& group = shape_groups[type];
+			auto& active = active_groups[type];
+			active.resize(group.size());
+			auto length = std::size_t{ 0 };
+			for( const auto i : group ) {
+				active[length] = i;
+				length += is_active[i];
+			}
+			active.resize(length);
+		}
+	}
+
+	void EntityStore::update_active_set(const std::vector<std::uint32_t>& slots) {
+		// Past this many slots the shifts cost more than a rebuild
+		constexpr std::size_t max_slots = 32;
+		if( slots.size() > max_slots ) {
+			update_active_set();
+			return;
+		}
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		for( const auto i : slots ) {
+			auto& active = active_groups[static_cast<std::size_t>(shape_types[i])];
+			const auto at = std::lower_bound(active.begin(), active.end(), i);
+			const auto is_listed = at != active.end() && *at == i;
+			if( is_active[i] && !is_listed ) {
+				active.insert(at, i);
+				// Join the runs ending just before or starting just after the index
+				const auto before = std::lower_bound(active_ranges.begin(), active_ranges.end(), i, [](const IndexRange& range, std::uint32_t index) { return range.end < index; });
+				const auto joins_before = before != active_ranges.end() && before->end == i;
+				const auto after = joins_before ? before + 1 : before;
+				const auto joins_after = after != active_ranges.end() && after->begin == i + 1;
+				if( joins_before && joins_after ) {
+					before->end = after->end;
+					active_ranges.erase(after);
+				}
+				else if( joins_before ) {
+					before->end = i + 1;
+				}
+				else if( joins_after ) {
+					after->begin = i;
+				}
+				else {
+					active_ranges.insert(after, { i, i + 1 });
+				}
+			}
+			else if( !is_active[i] && is_listed ) {
+				active.erase(at);
+				// Cut the index out of its run, splitting it if the index is inside
+				const auto range = std::upper_bound(active_ranges.begin(), active_ranges.end(), i, [](std::uint32_t index, const IndexRange& range) { return index < range.begin; }) - 1;
+				if( range->begin == i && range->end == i + 1 ) {
+					active_ranges.erase(range);
+				}
+				else if( range->begin == i ) {
+					++range->begin;
+				}
+				else if( range->end == i + 1 ) {
+					--range->end;
+				}
+				else {
+					const auto end = range->end;
+					range->end = i;
+					active_ranges.insert(range + 1, { i + 1, end });
+				}
+			}
+		}
+	}
+
+	void Selection::add(std::uint32_t i) {
+		if( !is_selected[i] ) {
+			is_selected[i] = 1;
+			indices.push_back(i);
+		}
+	}
+
+	void Selection::remove(std::uint32_t i) {
+		if( is_selected[i] ) {
+			is_selected[i] = 0;
+			std::erase(indices, i);
+		}
+	}
+
+	void Selection::clear() {
+		for( const auto i : indices ) {
+			is_selected[i] = 0;
+		}
+		indices.clear();
+	}
+
+	void Selection::resize(std::size_t count) {
+		if( count != is_selected.size() ) {
+			indices.clear();
+			is_selected.assign(count, 0);
+		}
+	}
+
+	NameId NameTable::intern(std::string_view name) {
+		if( !slots.empty() ) {
+			if( const auto id = slots[find_slot(name)]; id != empty_slot ) {
+				return id;
+			}
+		}
+		return append(name);
+	}
+
+	NameId NameTable::append(std::string_view name) {
+		A1_MEMORY_SCOPE(MemoryTag::names);
+		const auto id = static_cast<NameId>(size());
+		characters.insert(characters.end(), name.begin(), name.end());
+		characters.push_back('\0');
+		offsets.push_back(static_cast<std::uint32_t>(characters.size()));
+		if( 2 * size() > slots.size() ) {
+			rehash(std::max<std::size_t>(slots.size() * 2, 64));
+		}
+		else {
+			// Duplicates from append keep the first copy in the index
+			if( auto& slot = slots[find_slot(name)]; slot == empty_slot ) {
+				slot = id;
+			}
+		}
+		return id;
+	}
+
+	NameId NameTable::append_unindexed(std::string_view name) {
+		A1_MEMORY_SCOPE(MemoryTag::names);
+		const auto id = static_cast<NameId>(size());
+		characters.insert(characters.end(), name.begin(), name.end());
+		characters.push_back('\0');
+		offsets.push_back(static_cast<std::uint32_t>(characters.size()));
+		return id;
+	}
+
+	std::size_t NameTable::capacity_bytes() const {
+		return characters.capacity() * sizeof(char) + offsets.capacity() * sizeof(std::uint32_t) + slots.capacity() * sizeof(NameId);
+	}
+
+	NameId NameTable::find(std::string_view name) const {
+		return slots.empty() ? no_name : slots[find_slot(name)];
+	}
+
+	std::size_t NameTable::find_slot(std::string_view name) const {
+		const auto mask = slots.size() - 1;
+		for( auto slot = std::hash<std::string_view>{}(name) & mask; ; slot = (slot + 1) & mask ) {
+			if( slots[slot] == empty_slot || view(slots[slot]) == name ) {
+				return slot;
+			}
+		}
+	}
+
+	void NameTable::rehash(std::size_t slot_count) {
+		A1_MEMORY_SCOPE(MemoryTag::names);
+		slots.assign(slot_count, empty_slot);
+		for( NameId id = 0; id < size(); ++id ) {
+			if( auto& slot = slots[find_slot(view(id))]; slot == empty_slot ) {
+				slot = id;
+			}
+		}
+	}
+
+	void NameTable::reindex() {
+		auto slot_count = std::max<std::size_t>(slots.size(), 64);
+		while( slot_count < 2 * size() ) {
+			slot_count *= 2;
+		}
+		rehash(slot_count);
+	}
+
+	void NameTable::reserve(std::size_t count, std::size_t characters) {
+		A1_MEMORY_SCOPE(MemoryTag::names);
+		this->characters.reserve(characters + count);
+		offsets.reserve(count + 1);
+		auto slot_count = std::max<std::size_t>(slots.size(), 64);
+		while( slot_count < 2 * count ) {
+			slot_count *= 2;
+		}
+		if( slot_count != slots.size() ) {
+			rehash(slot_count);
+		}
+	}
+
+	void NameTable::truncate(std::size_t count) {
+		if( count >= size() ) {
+			return;
+		}
+		// Dropping a few names (e.g. renames since the last reset) deletes their
+		// slots with backward shifts; dropping many rebuilds the index
+		if( 4 * (size() - count) < count ) {
+			const auto mask = slots.size() - 1;
+			for( auto id = static_cast<NameId>(size() - 1); id >= count; --id ) {
+				auto hole = find_slot(view(id));
+				if( slots[hole] != id ) {
+					continue;
+				}
+				for( auto slot = (hole + 1) & mask; slots[slot] != empty_slot; slot = (slot + 1) & mask ) {
+					// Move an entry back into the hole unless its home slot lies
+					// cyclically in (hole, slot], where it would no longer be found
+					const auto home = std::hash<std::string_view>{}(view(slots[slot])) & mask;
+					if( ((slot - home) & mask) >= ((slot - hole) & mask) ) {
+						slots[hole] = slots[slot];
+						hole = slot;
+					}
+				}
+				slots[hole] = empty_slot;
+			}
+			characters.resize(offsets[count]);
+			offsets.resize(count + 1);
+		}
+		else {
+			characters.resize(offsets[count]);
+			offsets.resize(count + 1);
+			if( !slots.empty() ) {
+				rehash(slots.size());
+			}
+		}
+	}
+
+	MappedFile::MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+		auto input = std::ifstream{ path, std::ios::binary };
+		if( !input ) {
+			return;
+		}
+		contents.assign(std::istreambuf_iterator<char>{ input }, std::istreambuf_iterator<char>{});
+		data = contents.data();
+		size = contents.size();
+		opened = !input.bad();
+#else
+		const auto descriptor = ::open(path.c_str(), O_RDONLY);
+		if( descriptor < 0 ) {
+			return;
+		}
+		struct stat status;
+		if( ::fstat(descriptor, &status) == 0 ) {
+			size = static_cast<std::size_t>(status.st_size);
+			// Zero-length mappings are invalid; an empty file is just empty text
+			if( size == 0 ) {
+				opened = true;
+			}
+			else if( void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0); mapping != MAP_FAILED ) {
+				::madvise(mapping, size, MADV_SEQUENTIAL);
+				data = static_cast<const char*>(mapping);
+				opened = true;
+			}
+			else {
+				size = 0;
+			}
+		}
+		::close(descriptor);
+#endif
+	}
+
+	MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+		if( data != nullptr ) {
+			::munmap(const_cast<char*>(data), size);
+		}
+#endif
+	}
+
+	ConfigWatcher::ConfigWatcher(std::filesystem::path path) : file_path(std::move(path)) {
+		auto error = std::error_code{};
+		write_time = std::filesystem::last_write_time(file_path, error);
+		const auto file = MappedFile{ file_path };
+		applied_text = file.text();
+		next_poll = Clock::now() + poll_interval;
+	}
+
+	bool ConfigWatcher::poll() {
+		const auto now = Clock::now();
+		if( now < next_poll ) {
+			return false;
+		}
+		next_poll = now + poll_interval;
+		// A missing file (e.g. mid-save) is not a change; the next poll looks again
+		auto error = std::error_code{};
+		const auto time = std::filesystem::last_write_time(file_path, error);
+		if( error || time == write_time ) {
+			return false;
+		}
+		const auto file = MappedFile{ file_path };
+		if( !file.is_open() ) {
+			return false;
+		}
+		write_time = time;
+		pending_text = file.text();
+		return true;
+	}
+
+	namespace {
+		/**
+		 * Computes the capacity a buffer grows to when it must hold more elements.
+		 * @param capacity Current capacity
+		 * @param count Number of elements required
+		 * @return New capacity, at least count
+		 * @details Doubling means a growing scene reallocates O(log N) times.
+		 */
+		std::size_t grown_capacity(std::size_t capacity, std::size_t count) {
+			return std::max(count, capacity * 2);
+		}
+
+		/**
+		 * Grows the instance buffer of a vertex array to hold at least the specified count.
+		 * @param vao Vertex array reading the instance buffer
+		 * @param vbo Instance buffer, replaced when it grows
+		 * @param capacity Capacity of the instance buffer in instances, updated when it grows
+		 * @param count Number of instances
+		 * @param stride Size of one instance in bytes
+		 * @param set_attributes Points the instance attributes of the bound vertex array at the bound array buffer
+		 */
+		void reserve_instances(unsigned int vao, unsigned int& vbo, std::size_t& capacity, std::size_t count, std::size_t stride, void (*set_attributes)()) {
+			if( count <= capacity ) {
+				return;
+			}
+			capacity = grown_capacity(capacity, count);
+			rlEnableVertexArray(vao);
+			if( vbo != 0 ) {
+				rlUnloadVertexBuffer(vbo);
+			}
+			vbo = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * stride), true);
+			set_attributes();
+			rlDisableVertexArray();
+		}
+
+		/**
+		 * Draws everything raylib has queued, so it reaches the screen before a draw call of our own.
+		 */
+		void flush_batch() {
+			rlDrawRenderBatchActive();
+		}
+	}
+
+	bool ShapeRenderer::load(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path) {
+		unload();
+		shader = LoadShader(vs_path.string().c_str(), fs_path.string().c_str());
+		if( shader.id == 0 || shader.id == rlGetShaderIdDefault() ) {
+			shader = {};
+			return false;
+		}
+		mvp_location = rlGetLocationUniform(shader.id, "mvp");
+
+		// Two triangles covering the unit quad, expanded per instance in the shader.
+		// Counter-clockwise on screen (y down), or rlgl's back-face culling drops them
+		const float quad[] ={ -1, -1, -1, 1, 1, 1, -1, -1, 1, 1, 1, -1 };
+		vao = rlLoadVertexArray();
+		rlEnableVertexArray(vao);
+		quad_vbo = rlLoadVertexBuffer(quad, sizeof(quad), false);
+		rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, nullptr);
+		rlEnableVertexAttribute(0);
+		rlDisableVertexArray();
+		reserve_instances(vao, instance_vbo, instance_capacity, 1024, sizeof(ShapeInstance), set_instance_attributes);
+
+		buffer_vao = rlLoadVertexArray();
+		rlEnableVertexArray(buffer_vao);
+		rlEnableVertexBuffer(quad_vbo);
+		rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, nullptr);
+		rlEnableVertexAttribute(0);
+		rlDisableVertexArray();
+		return true;
+	}
+
+	void ShapeRenderer::unload() {
+		if( instance_vbo != 0 ) {
+			rlUnloadVertexBuffer(instance_vbo);
+		}
+		if( quad_vbo != 0 ) {
+			rlUnloadVertexBuffer(quad_vbo);
+		}
+		if( vao != 0 ) {
+			rlUnloadVertexArray(vao);
+		}
+		if( buffer_vao != 0 ) {
+			rlUnloadVertexArray(buffer_vao);
+		}
+		if( shader.id != 0 ) {
+			UnloadShader(shader);
+		}
+		shader = {};
+		vao = quad_vbo = instance_vbo = buffer_vao = 0;
+		instance_capacity = 0;
+	}
+
+	std::size_t ShapeRenderer::draw(const EntityStore& entities, const AABB& view, float point_size) {
+		if( chunk_instances.empty() ) {
+			chunk_instances.emplace_back();
+		}
+		build(entities, view, 0, entities.active_count(), point_size, chunk_instances.front());
+		return submit(1);
+	}
+
+	std::size_t ShapeRenderer::draw_parallel(const EntityStore& entities, const AABB& view, float point_size, int thread_count, std::size_t min_chunk_size) {
+#if defined(_OPENMP)
+		const auto max_threads = static_cast<std::size_t>(thread_count > 0 ? thread_count : omp_get_max_threads());
+		const auto count = entities.active_count();
+		const auto chunk_count = std::min(max_threads, count / std::max<std::size_t>(min_chunk_size, 1));
+		if( chunk_count <= 1 ) {
+			return draw(entities, view, point_size);
+		}
+		if( chunk_instances.size() < chunk_count ) {
+			chunk_instances.resize(chunk_count);
+		}
+		// Each thread only writes its own chunk's buffer, which keeps its
+		// capacity between frames
+		const auto chunk_size = (count + chunk_count - 1) / chunk_count;
+		const auto chunks = static_cast<long long>(chunk_count);
+		#pragma omp parallel for num_threads(static_cast<int>(chunk_count)) schedule(static)
+		for( long long chunk = 0; chunk < chunks; ++chunk ) {
+			const auto begin = std::min(static_cast<std::size_t>(chunk) * chunk_size, count);
+			build(entities, view, begin, std::min(begin + chunk_size, count), point_size, chunk_instances[static_cast<std::size_t>(chunk)]);
+		}
+		return submit(chunk_count);
+#else
+		return draw(entities, view, point_size);
+#endif
+	}
+
+	void ShapeRenderer::build(const EntityStore& entities, const AABB& view, std::size_t begin, std::size_t end, float point_size, std::vector<ShapeInstance>& instances) {
+		// Runs on OpenMP threads, which are outside the main thread's scopes
+		A1_MEMORY_SCOPE(MemoryTag::rendering);
+		instances.clear();
+		instances.reserve(end - begin);
+		const auto point_extent = point_size / 2;
+		auto group_begin = std::size_t{ 0 };
+		for( std::size_t type = 0; type < shape_type_count; ++type ) {
+			const auto& group = entities.active_groups[type];
+			const auto group_end = group_begin + group.size();
+			const auto first = std::clamp(begin, group_begin, group_end) - group_begin;
+			const auto last = std::clamp(end, group_begin, group_end) - group_begin;
+			for( auto k = first; k < last; ++k ) {
+				const auto i = group[k];
+				if( !intersects(render_aabb(entities, i), view) ) {
+					continue;
+				}
+				// A circle only a few pixels across is drawn as a square, which skips
+				// the per-fragment disc test
+				const auto half_width = entities.extent_x[i] * entities.scales[i];
+				const auto is_point = type == static_cast<std::size_t>(ShapeType::circle) && half_width < point_extent;
+				instances.push_back({
+					entities.render_x[i],
+					entities.render_y[i],
+					half_width,
+					entities.extent_y[i] * entities.scales[i],
+					pack_color(entities.colors[i]),
+					static_cast<float>(is_point ? static_cast<std::size_t>(ShapeType::rectangle) : type)
+				});
+			}
+			group_begin = group_end;
+		}
+	}
+
+	std::size_t ShapeRenderer::draw_buffer(unsigned int buffer, std::size_t count) {
+		if( count == 0 ) {
+			return 0;
+		}
+		flush_batch();
+		// The buffer may have been reallocated since the last draw, so the
+		// attributes are pointed at it every time
+		rlEnableVertexArray(buffer_vao);
+		rlEnableVertexBuffer(buffer);
+		set_instance_attributes();
+		rlEnableShader(shader.id);
+		rlSetUniformMatrix(mvp_location, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+		rlDrawVertexArrayInstanced(0, 6, static_cast<int>(count));
+		rlDisableVertexArray();
+		rlDisableVertexBuffer();
+		rlDisableShader();
+		return 1;
+	}
+
+	std::size_t ShapeRenderer::submit(std::size_t chunk_count) {
+		auto count = std::size_t{ 0 };
+		for( std::size_t chunk = 0; chunk < chunk_count; ++chunk ) {
+			count += chunk_instances[chunk].size();
+		}
+		if( count == 0 ) {
+			return 0;
+		}
+		reserve_instances(vao, instance_vbo, instance_capacity, count, sizeof(ShapeInstance), set_instance_attributes);
+		flush_batch();
+		auto offset = std::size_t{ 0 };
+		for( std::size_t chunk = 0; chunk < chunk_count; ++chunk ) {
+			const auto& instances = chunk_instances[chunk];
+			if( !instances.empty() ) {
+				rlUpdateVertexBuffer(instance_vbo, instances.data(), static_cast<int>(instances.size() * sizeof(ShapeInstance)), static_cast<int>(offset * sizeof(ShapeInstance)));
+				offset += instances.size();
+			}
+		}
+		rlEnableShader(shader.id);
+		rlSetUniformMatrix(mvp_location, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+		rlEnableVertexArray(vao);
+		rlDrawVertexArrayInstanced(0, 6, static_cast<int>(count));
+		rlDisableVertexArray();
+		rlDisableShader();
+		return 1;
+	}
+
+	void ShapeRenderer::set_instance_attributes() {
+		constexpr auto stride = static_cast<int>(sizeof(ShapeInstance));
+		rlSetVertexAttribute(1, 2, RL_FLOAT, false, stride, reinterpret_cast<const void*>(offsetof(ShapeInstance, x)));
+		rlSetVertexAttribute(2, 2, RL_FLOAT, false, stride, reinterpret_cast<const void*>(offsetof(ShapeInstance, half_width)));
+		rlSetVertexAttribute(3, 4, RL_UNSIGNED_BYTE, true, stride, reinterpret_cast<const void*>(offsetof(ShapeInstance, color)));
+		rlSetVertexAttribute(4, 1, RL_FLOAT, false, stride, reinterpret_cast<const void*>(offsetof(ShapeInstance, shape_type)));
+		for( unsigned int attribute = 1; attribute <= 4; ++attribute ) {
+			rlEnableVertexAttribute(attribute);
+			rlSetVertexAttributeDivisor(attribute, 1);
+		}
+	}
+
+	bool TextRenderer::load(const std::filesystem::path& font_path, const std::filesystem::path& vs_path, const std::filesystem::path& fs_path) {
+		unload();
+		return prepare(font_path) && upload(vs_path, fs_path);
+	}
+
+	bool TextRenderer::prepare(const std::filesystem::path& font_path) {
+		auto file_size = 0;
+		auto* file_data = LoadFileData(font_path.string().c_str(), &file_size);
+		if( file_data == nullptr ) {
+			return false;
+		}
+		// Printable ASCII, as LoadFont loads by default
+		constexpr auto glyph_count = 95;
+		sdf_font.baseSize = sdf_font_size;
+		sdf_font.glyphCount = glyph_count;
+		sdf_font.glyphs = LoadFontData(file_data, file_size, sdf_font_size, nullptr, glyph_count, FONT_SDF);
+		UnloadFileData(file_data);
+		if( sdf_font.glyphs == nullptr ) {
+			sdf_font = {};
+			return false;
+		}
+		atlas = GenImageFontAtlas(sdf_font.glyphs, &sdf_font.recs, glyph_count, sdf_font_size, 0, 1);
+		for( int c = 0; c < static_cast<int>(ascii_glyphs.size()); ++c ) {
+			ascii_glyphs[static_cast<std::size_t>(c)] = GetGlyphIndex(sdf_font, c);
+		}
+		return true;
+	}
+
+	bool TextRenderer::upload(const std::filesystem::path& vs_path, const std::filesystem::path& fs_path) {
+		if( atlas.data == nullptr ) {
+			return false;
+		}
+		sdf_font.texture = LoadTextureFromImage(atlas);
+		UnloadImage(atlas);
+		atlas = {};
+		SetTextureFilter(sdf_font.texture, TEXTURE_FILTER_BILINEAR);
+
+		shader = LoadShader(vs_path.string().c_str(), fs_path.string().c_str());
+		if( shader.id == 0 || shader.id == rlGetShaderIdDefault() ) {
+			shader = {};
+			unload();
+			return false;
+		}
+		mvp_location = rlGetLocationUniform(shader.id, "mvp");
+		color_location = rlGetLocationUniform(shader.id, "textColor");
+		texture_location = rlGetLocationUniform(shader.id, "texture0");
+
+		// Two triangles covering the unit quad, placed over each glyph in the shader,
+		// counter-clockwise on screen like the shape renderer's
+		const float quad[] ={ 0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0 };
+		vao = rlLoadVertexArray();
+		rlEnableVertexArray(vao);
+		quad_vbo = rlLoadVertexBuffer(quad, sizeof(quad), false);
+		rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, nullptr);
+		rlEnableVertexAttribute(0);
+		rlDisableVertexArray();
+		reserve_instances(vao, instance_vbo, instance_capacity, 4096, sizeof(GlyphInstance), set_instance_attributes);
+		return true;
+	}
+
+	void TextRenderer::unload() {
+		if( instance_vbo != 0 ) {
+			rlUnloadVertexBuffer(instance_vbo);
+		}
+		if( quad_vbo != 0 ) {
+			rlUnloadVertexBuffer(quad_vbo);
+		}
+		if( vao != 0 ) {
+			rlUnloadVertexArray(vao);
+		}
+		if( shader.id != 0 ) {
+			UnloadShader(shader);
+		}
+		if( sdf_font.glyphs != nullptr ) {
+			UnloadFont(sdf_font);
+		}
+		if( atlas.data != nullptr ) {
+			UnloadImage(atlas);
+		}
+		sdf_font = {};
+		atlas = {};
+		shader = {};
+		vao = quad_vbo = instance_vbo = 0;
+		instance_capacity = 0;
+	}
+
+	std::size_t TextRenderer::draw(const Input& input, const EntityStore& entities, const AABB& view) {
+		build(input, entities, view);
+		if( instances.empty() ) {
+			return 0;
+		}
+		reserve_instances(vao, instance_vbo, instance_capacity, instances.size(), sizeof(GlyphInstance), set_instance_attributes);
+		flush_batch();
+		rlUpdateVertexBuffer(instance_vbo, instances.data(), static_cast<int>(instances.size() * sizeof(GlyphInstance)), 0);
+		const float color[] ={ input.text_color[0], input.text_color[1], input.text_color[2], 1.0f };
+		const auto slot = 0;
+		rlEnableShader(shader.id);
+		rlSetUniformMatrix(mvp_location, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+		rlSetUniform(color_location, color, RL_SHADER_UNIFORM_VEC4, 1);
+		rlSetUniform(texture_location, &slot, RL_SHADER_UNIFORM_INT, 1);
+		rlActiveTextureSlot(slot);
+		rlEnableTexture(sdf_font.texture.id);
+		rlEnableVertexArray(vao);
+		rlDrawVertexArrayInstanced(0, 6, static_cast<int>(instances.size()));
+		rlDisableVertexArray();
+		rlDisableTexture();
+		rlDisableShader();
+		return 1;
+	}
+
+	void TextRenderer::build(const Input& input, const EntityStore& entities, const AABB& view) {
+		instances.clear();
+		const auto scale = input.text_size / static_cast<float>(sdf_font.baseSize);
+		const auto padding = static_cast<float>(sdf_font.glyphPadding);
+		const auto atlas_width = static_cast<float>(sdf_font.texture.width);
+		const auto atlas_height = static_cast<float>(sdf_font.texture.height);
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				const auto width = entities.name_width[entities.names[i]];
+				const auto height = entities.name_height[entities.names[i]];
+				const auto tag = AABB{ entities.render_x[i] - width / 2, entities.render_y[i] - height / 2, width, height };
+				if( !intersects(tag, view) ) {
+					continue;
+				}
+				// Same placement and advance as DrawTextEx with 1 pixel spacing
+				auto pen_x = tag.x;
+				const auto* text = entities.name(i);
+				while( *text != '\0' ) {
+					auto bytes = 1;
+					const auto c = static_cast<unsigned char>(*text);
+					const auto glyph = c < ascii_glyphs.size() ? ascii_glyphs[c] : GetGlyphIndex(sdf_font, GetCodepointNext(text, &bytes));
+					text += bytes;
+					const auto& info = sdf_font.glyphs[glyph];
+					const auto& rec = sdf_font.recs[glyph];
+					if( info.value != ' ' && info.value != '\t' ) {
+						instances.push_back({
+							pen_x + (info.offsetX - padding) * scale,
+							tag.y + (info.offsetY - padding) * scale,
+							(rec.width + 2 * padding) * scale,
+							(rec.height + 2 * padding) * scale,
+							(rec.x - padding) / atlas_width,
+							(rec.y - padding) / atlas_height,
+							(rec.x + rec.width + padding) / atlas_width,
+							(rec.y + rec.height + padding) / atlas_height
+						});
+					}
+					pen_x += (info.advanceX == 0 ? rec.width : static_cast<float>(info.advanceX)) * scale + 1.0f;
+				}
+			}
+		}
+	}
+
+	void TextRenderer::set_instance_attributes() {
+		constexpr auto stride = static_cast<int>(sizeof(GlyphInstance));
+		rlSetVertexAttribute(1, 4, RL_FLOAT, false, stride, reinterpret_cast<const void*>(offsetof(GlyphInstance, x)));
+		rlSetVertexAttribute(2, 4, RL_FLOAT, false, stride, reinterpret_cast<const void*>(offsetof(GlyphInstance, u0)));
+		for( unsigned int attribute = 1; attribute <= 2; ++attribute ) {
+			rlEnableVertexAttribute(attribute);
+			rlSetVertexAttributeDivisor(attribute, 1);
+		}
+	}
+
+	void SceneCache::begin(int width, int height) {
+		if( target.id == 0 || target.texture.width != width || target.texture.height != height ) {
+			unload();
+			target = LoadRenderTexture(width, height);
+		}
+		BeginTextureMode(target);
+		ClearBackground(::Color{ 0, 0, 0, 255 });
+	}
+
+	void SceneCache::end() {
+		EndTextureMode();
+		valid = true;
+	}
+
+	std::size_t SceneCache::draw() const {
+		// Render textures are stored bottom-up, so the source rectangle flips them
+		const auto width = static_cast<float>(target.texture.width);
+		const auto height = static_cast<float>(target.texture.height);
+		DrawTextureRec(target.texture, { 0.0f, 0.0f, width, -height }, { 0.0f, 0.0f }, ::Color{ 255, 255, 255, 255 });
+		return 1;
+	}
+
+	void SceneCache::unload() {
+		if( target.id != 0 ) {
+			UnloadRenderTexture(target);
+		}
+		target = {};
+		valid = false;
+	}
+
+	std::size_t SceneCache::gpu_bytes() const {
+		if( target.id == 0 ) {
+			return 0;
+		}
+		// raylib attaches a 24-bit depth renderbuffer, which drivers pad to 32 bits
+		const auto& texture = target.texture;
+		return static_cast<std::size_t>(GetPixelDataSize(texture.width, texture.height, texture.format)) + static_cast<std::size_t>(texture.width) * texture.height * 4;
+	}
+
+	void CollisionGrid::build(const EntityStore& entities, const World& world) {
+		// Size cells to the mean box side so a typical entity spans up to four
+		// cells and, at moderate density, a typical cell holds a few entities
+		auto extent_sum = 0.0f;
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				extent_sum += (entities.extent_x[i] + entities.extent_y[i]) * entities.scales[i];
+			}
+		}
+		const auto active_count = entities.active_count();
+		cell_size = active_count == 0 ? 1.0f : std::max(extent_sum / active_count, 1.0f);
+		columns = std::max(static_cast<int>(std::ceil(world.width / cell_size)), 1);
+		rows = std::max(static_cast<int>(std::ceil(world.height / cell_size)), 1);
+		const auto cell_count = static_cast<std::size_t>(columns) * rows;
+
+		// Counting sort: count entries per cell, prefix sum, then fill
+		cell_start.assign(cell_count + 1, 0);
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				int first_column, first_row, last_column, last_row;
+				cell_range(entity_aabb(entities, i), first_column, first_row, last_column, last_row);
+				for( auto row = first_row; row <= last_row; ++row ) {
+					for( auto column = first_column; column <= last_column; ++column ) {
+						++cell_start[static_cast<std::size_t>(row) * columns + column + 1];
+					}
+				}
+			}
+		}
+		for( std::size_t cell = 0; cell < cell_count; ++cell ) {
+			cell_start[cell + 1] += cell_start[cell];
+		}
+		cell_entities.resize(cell_start[cell_count]);
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				int first_column, first_row, last_column, last_row;
+				cell_range(entity_aabb(entities, i), first_column, first_row, last_column, last_row);
+				for( auto row = first_row; row <= last_row; ++row ) {
+					for( auto column = first_column; column <= last_column; ++column ) {
+						// cell_start[cell] is advanced to the cell's end while filling, and
+						// shifted back afterwards
+						cell_entities[cell_start[static_cast<std::size_t>(row) * columns + column]++] = i;
+					}
+				}
+			}
+		}
+		for( auto cell = cell_count; cell > 0; --cell ) {
+			cell_start[cell] = cell_start[cell - 1];
+		}
+		cell_start[0] = 0;
+	}
+
+	void CollisionGrid::cell_range(const AABB& aabb, int& first_column, int& first_row, int& last_column, int& last_row) const {
+		const auto to_cell = [this](float coordinate, int cells) {
+			return std::clamp(static_cast<int>(std::floor(coordinate / cell_size)), 0, cells - 1);
+		};
+		first_column = to_cell(aabb.x, columns);
+		first_row = to_cell(aabb.y, rows);
+		last_column = to_cell(aabb.x + aabb.width, columns);
+		last_row = to_cell(aabb.y + aabb.height, rows);
+	}
+
+	void CollisionGrid::resolve(EntityStore& entities, const World& world) {
+		build(entities, world);
+		contacts = 0;
+		for( int row = 0; row < rows; ++row ) {
+			for( int column = 0; column < columns; ++column ) {
+				const auto cell = static_cast<std::size_t>(row) * columns + column;
+				const auto begin = cell_start[cell];
+				const auto end = cell_start[cell + 1];
+				for( auto first = begin; first < end; ++first ) {
+					const auto a = cell_entities[first];
+					const auto box_a = entity_aabb(entities, a);
+					for( auto second = first + 1; second < end; ++second ) {
+						const auto b = cell_entities[second];
+						const auto box_b = entity_aabb(entities, b);
+						if( box_a.x > box_b.x + box_b.width || box_b.x > box_a.x + box_a.width
+							|| box_a.y > box_b.y + box_b.height || box_b.y > box_a.y + box_a.height ) {
+							continue;
+						}
+						// Only the cell holding the top-left corner of the boxes'
+						// intersection owns the pair
+						int owner_column, owner_row, unused_column, unused_row;
+						cell_range(
+							{ std::max(box_a.x, box_b.x), std::max(box_a.y, box_b.y), 0.0f, 0.0f },
+							owner_column, owner_row, unused_column, unused_row
+						);
+						if( owner_column != column || owner_row != row ) {
+							continue;
+						}
+						if( collide(entities, a, b) ) {
+							++contacts;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	namespace {
+		constexpr std::array<const char*, profile_phase_count> profile_phase_names{ "Input", "Simulation", "Rendering", "UI", "Present" };
+
+		float milliseconds(Profiler::Clock::duration duration) {
+			return std::chrono::duration<float, std::milli>(duration).count();
+		}
+	}
+
+	void Profiler::begin_frame() {
+		current = Frame{};
+		current.start = Clock::now();
+	}
+
+	void Profiler::end_frame(std::size_t entities, std::size_t draw_calls) {
+		current.duration_ms = milliseconds(Clock::now() - current.start);
+		current.entities = entities;
+		current.draw_calls = draw_calls;
+		frames[next] = current;
+		next = (next + 1) % history_size;
+		count = std::min(count + 1, history_size);
+	}
+
+	void Profiler::record(ProfilePhase phase, Clock::time_point start, Clock::time_point end) {
+		const auto index = static_cast<std::size_t>(phase);
+		// A phase timed more than once per frame keeps its first start and sums its durations
+		if( current.phase_ms[index] == 0.0f ) {
+			current.phase_start_ms[index] = milliseconds(start - current.start);
+		}
+		current.phase_ms[index] += milliseconds(end - start);
+	}
+
+	void Profiler::draw_ui() {
+		ImGui::SetNextWindowSize(ImVec2(500, 420), ImGuiCond_FirstUseEver);
+		if( !ImGui::Begin("Profiler") ) {
+			ImGui::End();
+			return;
+		}
+		if( count == 0 ) {
+			ImGui::Text("No frames recorded yet");
+			ImGui::End();
+			return;
+		}
+
+		// Frame times oldest to newest, with averages over the whole history
+		auto frame_ms = std::array<float, history_size>{};
+		auto average = Frame{};
+		auto worst_ms = 0.0f;
+		for( std::size_t i = 0; i < count; ++i ) {
+			const auto& recorded = frame(i);
+			frame_ms[i] = recorded.duration_ms;
+			average.duration_ms += recorded.duration_ms;
+			worst_ms = std::max(worst_ms, recorded.duration_ms);
+			for( std::size_t phase = 0; phase < profile_phase_count; ++phase ) {
+				average.phase_ms[phase] += recorded.phase_ms[phase];
+			}
+		}
+		average.duration_ms /= count;
+		for( auto& phase_ms : average.phase_ms ) {
+			phase_ms /= count;
+		}
+		const auto& latest = frame(count - 1);
+
+		ImGui::Text("Frame: %.2f ms avg, %.2f ms worst (%.0f FPS)", average.duration_ms, worst_ms, average.duration_ms > 0.0f ? 1000.0f / average.duration_ms : 0.0f);
+		ImGui::PlotLines("##frame_times", frame_ms.data(), static_cast<int>(count), 0, nullptr, 0.0f, std::max(worst_ms, 1.0f), ImVec2(-1, 80));
+
+		for( std::size_t phase = 0; phase < profile_phase_count; ++phase ) {
+			const auto fraction = average.duration_ms > 0.0f ? average.phase_ms[phase] / average.duration_ms : 0.0f;
+			char overlay[32];
+			std::snprintf(overlay, sizeof(overlay), "%.2f ms", average.phase_ms[phase]);
+			ImGui::ProgressBar(fraction, ImVec2(200, 0), overlay);
+			ImGui::SameLine();
+			ImGui::Text("%s", profile_phase_names[phase]);
+		}
+
+		ImGui::Text("Entities: %zu", latest.entities);
+		ImGui::Text("Draw Calls: %zu", latest.draw_calls);
+		if( ImGui::Button("Save Chrome Trace") ) {
+			write_chrome_trace("profile.json");
+		}
+		ImGui::End();
+	}
+
+	bool Profiler::write_chrome_trace(const std::filesystem::path& path) const {
+		auto output = std::ofstream{ path };
+		if( !output ) {
+			return false;
+		}
+		// Complete ("X") events with microsecond timestamps; each frame is one
+		// event and its phases nest inside it on the same thread track
+		output << "{\"traceEvents\":[\n";
+		auto first = true;
+		const auto write_event = [&](const char* name, double start_us, double duration_us, std::size_t frame_index) {
+			output
+				<< (first ? "" : ",\n")
+				<< "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+				<< ",\"ts\":" << start_us << ",\"dur\":" << duration_us
+				<< ",\"args\":{\"frame\":" << frame_index << "}}";
+			first = false;
+		};
+		output.precision(3);
+		output << std::fixed;
+		for( std::size_t i = 0; i < count; ++i ) {
+			const auto& recorded = frame(i);
+			const auto start_us = std::chrono::duration<double, std::micro>(recorded.start - epoch).count();
+			write_event("Frame", start_us, recorded.duration_ms * 1000.0, i);
+			for( std::size_t phase = 0; phase < profile_phase_count; ++phase ) {
+				if( recorded.phase_ms[phase] > 0.0f ) {
+					write_event(profile_phase_names[phase], start_us + recorded.phase_start_ms[phase] * 1000.0, recorded.phase_ms[phase] * 1000.0, i);
+				}
+			}
+		}
+		output << "\n]}\n";
+		return static_cast<bool>(output);
+	}
+
+	namespace {
+		constexpr std::array<const char*, memory_tag_count> memory_tag_names{ "Other", "Config", "Entities", "Names", "Simulation", "Rendering", "UI" };
+		constexpr std::array<const char*, MemoryPanel::gpu_part_count> gpu_part_names{ "Shape Instances", "Font Atlas", "Text Instances", "Scene Cache", "GPU Simulation" };
+
+		// Precedes every tracked block; the alignment keeps the block aligned like malloc's
+		struct alignas(std::max_align_t) AllocationHeader {
+			std::size_t size;
+			MemoryTag tag;
+		};
+
+		struct MemoryCounters {
+			std::atomic<std::size_t> live_bytes{ 0 };
+			std::atomic<std::size_t> peak_bytes{ 0 };
+			std::atomic<std::size_t> allocations{ 0 };
+		};
+
+		// Constant-initialized, so allocations made before main are counted too
+		std::array<MemoryCounters, memory_tag_count> memory_counters;
+		thread_local MemoryTag memory_tag = MemoryTag::other;
+
+		/**
+		 * Adds a table row of byte counts in KiB.
+		 * @param label Row label
+		 * @param bytes Current size
+		 * @param peak_bytes High-water mark
+		 */
+		void memory_row(const char* label, std::size_t bytes, std::size_t peak_bytes) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(label);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f KiB", bytes / 1024.0);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f KiB", peak_bytes / 1024.0);
+		}
+	}
+
+	MemoryScope::MemoryScope(MemoryTag tag) : previous(memory_tag) {
+		memory_tag = tag;
+	}
+
+	MemoryScope::~MemoryScope() {
+		memory_tag = previous;
+	}
+
+	void MemoryPanel::end_frame(const EntityStore& entities, const Font& font, const ShapeRenderer& shape_renderer, const TextRenderer& text_renderer, const SceneCache& scene_cache, const GpuSimulation& gpu_simulation) {
+		for( std::size_t tag = 0; tag < memory_tag_count; ++tag ) {
+			const auto count = memory_usage(static_cast<MemoryTag>(tag)).allocations;
+			frame_allocations[tag] = count - allocations[tag];
+			allocations[tag] = count;
+		}
+		entity_count = entities.size();
+		store = entities.memory();
+		store_peak.components = std::max(store_peak.components, store.components);
+		store_peak.shapes = std::max(store_peak.shapes, store.shapes);
+		store_peak.names = std::max(store_peak.names, store.names);
+		const auto& atlas = font.texture;
+		gpu ={
+			shape_renderer.gpu_bytes(),
+			atlas.id != 0 ? static_cast<std::size_t>(GetPixelDataSize(atlas.width, atlas.height, atlas.format)) : 0,
+			text_renderer.gpu_bytes(),
+			scene_cache.gpu_bytes(),
+			gpu_simulation.gpu_bytes()
+		};
+		for( std::size_t part = 0; part < gpu_part_count; ++part ) {
+			gpu_peak[part] = std::max(gpu_peak[part], gpu[part]);
+		}
+	}
+
+	void MemoryPanel::draw_ui() const {
+		ImGui::SetNextWindowSize(ImVec2(560, 640), ImGuiCond_FirstUseEver);
+		if( !ImGui::Begin("Memory") ) {
+			ImGui::End();
+			return;
+		}
+		constexpr auto table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+
+		ImGui::SeparatorText("Heap");
+		if( ImGui::BeginTable("##heap", 4, table_flags) ) {
+			ImGui::TableSetupColumn("Subsystem");
+			ImGui::TableSetupColumn("Live");
+			ImGui::TableSetupColumn("Peak");
+			ImGui::TableSetupColumn("Allocs/Frame");
+			ImGui::TableHeadersRow();
+			auto live_bytes = std::size_t{ 0 };
+			auto frame_count = std::size_t{ 0 };
+			for( std::size_t tag = 0; tag < memory_tag_count; ++tag ) {
+				const auto usage = memory_usage(static_cast<MemoryTag>(tag));
+				memory_row(memory_tag_names[tag], usage.live_bytes, usage.peak_bytes);
+				ImGui::TableNextColumn();
+				ImGui::Text("%zu", frame_allocations[tag]);
+				live_bytes += usage.live_bytes;
+				frame_count += frame_allocations[tag];
+			}
+			// Subsystems peak at different times, so their peaks do not add up
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted("Total");
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f KiB", live_bytes / 1024.0);
+			ImGui::TableNextColumn();
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", frame_count);
+			ImGui::EndTable();
+		}
+
+		ImGui::SeparatorText("Entity Store");
+		if( ImGui::BeginTable("##store", 3, table_flags) ) {
+			ImGui::TableSetupColumn("Part");
+			ImGui::TableSetupColumn("Capacity");
+			ImGui::TableSetupColumn("Peak");
+			ImGui::TableHeadersRow();
+			memory_row("Components", store.components, store_peak.components);
+			memory_row("Shapes", store.shapes, store_peak.shapes);
+			memory_row("Names", store.names, store_peak.names);
+			ImGui::EndTable();
+		}
+		const auto store_bytes = store.components + store.shapes + store.names;
+		ImGui::Text("%.1f bytes per entity (%zu entities)", entity_count > 0 ? static_cast<double>(store_bytes) / entity_count : 0.0, entity_count);
+
+		ImGui::SeparatorText("GPU (estimated)");
+		if( ImGui::BeginTable("##gpu", 3, table_flags) ) {
+			ImGui::TableSetupColumn("Buffer");
+			ImGui::TableSetupColumn("Size");
+			ImGui::TableSetupColumn("Peak");
+			ImGui::TableHeadersRow();
+			for( std::size_t part = 0; part < gpu_part_count; ++part ) {
+				memory_row(gpu_part_names[part], gpu[part], gpu_peak[part]);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::End();
+	}
+
+	std::uint32_t MotionSettings::features() const {
+		auto flags = std::uint32_t{ 0 };
+		if( wrap ) {
+			flags |= static_cast<std::uint32_t>(MotionFeature::wrap);
+		}
+		if( gravity != 0.0f ) {
+			flags |= static_cast<std::uint32_t>(MotionFeature::gravity);
+		}
+		if( damping != 0.0f ) {
+			flags |= static_cast<std::uint32_t>(MotionFeature::damping);
+		}
+		return flags;
+	}
+
+	int SimulationClock::advance(double step, int max_steps, float frame_time) {
+		accumulator += frame_time;
+		auto steps = 0;
+		while( steps < max_steps && accumulator >= step ) {
+			accumulator -= step;
+			++steps;
+		}
+		accumulator = std::min(accumulator, step);
+		alpha = static_cast<float>(accumulator / step);
+		return steps;
+	}
+
+	void EditLog::queue(const Input& input, const EntityStore& entities) {
+		if( input.changed(InputChange::spawn) ) {
+			spawned.insert(spawned.end(), input.spawn_slots.begin(), input.spawn_slots.end());
+		}
+		if( input.changed(InputChange::selection) || !entities.contains(input.selected) ) {
+			return;
+		}
+		constexpr auto entity_changes = static_cast<std::uint32_t>(InputChange::is_active) | static_cast<std::uint32_t>(InputChange::scale)
+			| static_cast<std::uint32_t>(InputChange::velocity_x) | static_cast<std::uint32_t>(InputChange::velocity_y)
+			| static_cast<std::uint32_t>(InputChange::color);
+		if( (input.changes & entity_changes) != 0 ) {
+			changes |= input.changes & entity_changes;
+			edited.insert(edited.end(), input.selection.indices.begin(), input.selection.indices.end());
+		}
+		if( input.changed(InputChange::name) ) {
+			renamed.push_back(input.selected.index);
+		}
+	}
+
+	void EditLog::apply(const EntityStore& source, EntityStore& target) const {
+		for( const auto i : edited ) {
+			if( changed(InputChange::is_active) ) {
+				target.is_active[i] = source.is_active[i];
+			}
+			if( changed(InputChange::scale) ) {
+				target.scales[i] = source.scales[i];
+			}
+			if( changed(InputChange::color) ) {
+				target.colors[i] = source.colors[i];
+			}
+		}
+		// Velocities, and the motion of spawned slots
+		apply_motion(source, target);
+		for( const auto i : spawned ) {
+			target.scales[i] = source.scales[i];
+			target.colors[i] = source.colors[i];
+			target.extent_x[i] = source.extent_x[i];
+			target.extent_y[i] = source.extent_y[i];
+			target.is_active[i] = source.is_active[i];
+			target.generations[i] = source.generations[i];
+			target.rename({ i }, source.name_table.view(source.names[i]));
+		}
+		if( changed(InputChange::is_active) ) {
+			target.update_active_set();
+		}
+		else if( !spawned.empty() ) {
+			target.update_active_set(spawned);
+		}
+		for( const auto i : renamed ) {
+			target.rename({ i }, source.name_table.view(source.names[i]));
+		}
+	}
+
+	void EditLog::apply_motion(const EntityStore& source, EntityStore& target) const {
+		for( const auto i : edited ) {
+			if( changed(InputChange::velocity_x) ) {
+				target.velocity_x[i] = source.velocity_x[i];
+			}
+			if( changed(InputChange::velocity_y) ) {
+				target.velocity_y[i] = source.velocity_y[i];
+			}
+		}
+		for( const auto i : spawned ) {
+			target.position_x[i] = source.position_x[i];
+			target.position_y[i] = source.position_y[i];
+			target.previous_x[i] = source.previous_x[i];
+			target.previous_y[i] = source.previous_y[i];
+			target.render_x[i] = source.render_x[i];
+			target.render_y[i] = source.render_y[i];
+			target.velocity_x[i] = source.velocity_x[i];
+			target.velocity_y[i] = source.velocity_y[i];
+		}
+	}
+
+	void EditLog::clear() {
+		changes = 0;
+		edited.clear();
+		renamed.clear();
+		spawned.clear();
+	}
+
+	SimulationPipeline::~SimulationPipeline() {
+		{
+			const auto lock = std::lock_guard{ mutex };
+			is_stopping = true;
+		}
+		condition.notify_all();
+		if( worker.joinable() ) {
+			worker.join();
+		}
+	}
+
+	void SimulationPipeline::queue_edits(const Input& input, const EntityStore& entities) {
+		if( input.changed(InputChange::scene) ) {
+			is_synced = false;
+		}
+		if( is_synced ) {
+			edits.queue(input, entities);
+		}
+	}
+
+	void SimulationPipeline::sync(EntityStore& entities) {
+		wait();
+		if( !is_synced || state.size() != entities.size() ) {
+			state = entities;
+			clock = {};
+			is_synced = true;
+			is_published = false;
+		}
+		else {
+			edits.apply(entities, state);
+			if( is_published ) {
+				entities.position_x.swap(published.position_x);
+				entities.position_y.swap(published.position_y);
+				entities.previous_x.swap(published.previous_x);
+				entities.previous_y.swap(published.previous_y);
+				entities.velocity_x.swap(published.velocity_x);
+				entities.velocity_y.swap(published.velocity_y);
+				entities.render_x.swap(published.render_x);
+				entities.render_y.swap(published.render_y);
+				is_published = false;
+				// The published components were copied before this sync's edits
+				edits.apply_motion(state, entities);
+			}
+		}
+		edits.clear();
+	}
+
+	void SimulationPipeline::start(const Input& input, const World& world, float frame_time) {
+		wait();
+		settings.simulate_enabled = input.simulate_enabled;
+		settings.parallel_enabled = input.parallel_enabled;
+		settings.collide_enabled = input.collide_enabled;
+		settings.motion = input.motion;
+		settings.thread_count = input.thread_count;
+		settings.min_chunk_size = input.min_chunk_size;
+		settings.tick_rate = input.tick_rate;
+		settings.max_catch_up_steps = input.max_catch_up_steps;
+		this->world = world;
+		this->frame_time = frame_time;
+		if( !worker.joinable() ) {
+			worker = std::thread{ &SimulationPipeline::run, this };
+		}
+		{
+			const auto lock = std::lock_guard{ mutex };
+			is_pending = true;
+		}
+		condition.notify_all();
+	}
+
+	void SimulationPipeline::stop() {
+		wait();
+		is_synced = false;
+		edits.clear();
+	}
+
+	void SimulationPipeline::run() {
+		A1_MEMORY_SCOPE(MemoryTag::simulation);
+		auto lock = std::unique_lock{ mutex };
+		while( true ) {
+			condition.wait(lock, [this] { return is_pending || is_stopping; });
+			if( is_stopping ) {
+				return;
+			}
+			lock.unlock();
+			handle_simulation(settings, world, state, clock, collision_grid, frame_time);
+			// Copying here keeps it off the main thread, which only swaps at the next sync
+			published.position_x = state.position_x;
+			published.position_y = state.position_y;
+			published.previous_x = state.previous_x;
+			published.previous_y = state.previous_y;
+			published.velocity_x = state.velocity_x;
+			published.velocity_y = state.velocity_y;
+			published.render_x = state.render_x;
+			published.render_y = state.render_y;
+			lock.lock();
+			is_published = true;
+			is_pending = false;
+			condition.notify_all();
+		}
+	}
+
+	namespace {
+		// OpenGL 4.3 enums rlgl does not define
+		constexpr unsigned int gl_array_buffer = 0x8892;
+		constexpr unsigned int gl_shader_storage_buffer = 0x90D2;
+		constexpr unsigned int gl_link_status = 0x8B82;
+		constexpr unsigned int gl_major_version = 0x821B;
+		constexpr unsigned int gl_minor_version = 0x821C;
+		constexpr unsigned int gl_vertex_attrib_array_barrier_bit = 0x0001;
+		constexpr unsigned int gl_buffer_update_barrier_bit = 0x0200;
+		constexpr unsigned int gl_shader_storage_barrier_bit = 0x2000;
+
+		/**
+		 * Resolves an OpenGL entry point into a typed function pointer.
+		 * @param function Function pointer (output)
+		 * @param name OpenGL function name
+		 * @return true if the context provides the function
+		 */
+		template<typename Function>
+		bool load_gl_function(Function& function, const char* name) {
+			function = reinterpret_cast<Function>(glfwGetProcAddress(name));
+			return function != nullptr;
+		}
+	}
+
+	bool GpuSimulation::load(const std::filesystem::path& cs_path) {
+		unload();
+		auto api = Api{};
+		const auto is_loaded = load_gl_function(api.get_integer, "glGetIntegerv")
+			&& load_gl_function(api.create_program, "glCreateProgram")
+			&& load_gl_function(api.attach_shader, "glAttachShader")
+			&& load_gl_function(api.link_program, "glLinkProgram")
+			&& load_gl_function(api.get_program, "glGetProgramiv")
+			&& load_gl_function(api.delete_shader, "glDeleteShader")
+			&& load_gl_function(api.bind_buffer_base, "glBindBufferBase")
+			&& load_gl_function(api.get_buffer_sub_data, "glGetBufferSubData")
+			&& load_gl_function(api.dispatch_compute, "glDispatchCompute")
+			&& load_gl_function(api.memory_barrier, "glMemoryBarrier");
+		// Drivers may export the functions of versions the context does not provide
+		auto major = 0;
+		auto minor = 0;
+		if( is_loaded ) {
+			api.get_integer(gl_major_version, &major);
+			api.get_integer(gl_minor_version, &minor);
+		}
+		if( !is_loaded || major * 10 + minor < 43 ) {
+			TraceLog(LOG_INFO, "COMPUTE: OpenGL 4.3 is not available (context is %d.%d), simulating on the CPU", major, minor);
+			return false;
+		}
+		gl = api;
+
+		auto* code = LoadFileText(cs_path.string().c_str());
+		if( code == nullptr ) {
+			return false;
+		}
+		const auto shader = rlCompileShader(code, RL_COMPUTE_SHADER);
+		UnloadFileText(code);
+		program = gl.create_program();
+		gl.attach_shader(program, shader);
+		gl.link_program(program);
+		// A shader that failed to compile fails the link too
+		gl.delete_shader(shader);
+		auto is_linked = 0;
+		gl.get_program(program, gl_link_status, &is_linked);
+		if( is_linked == 0 ) {
+			TraceLog(LOG_WARNING, "COMPUTE: [%s] Failed to build the compute shader", cs_path.string().c_str());
+			unload();
+			return false;
+		}
+		active_count_location = rlGetLocationUniform(program, "activeCount");
+		circle_count_location = rlGetLocationUniform(program, "circleCount");
+		steps_location = rlGetLocationUniform(program, "steps");
+		dt_location = rlGetLocationUniform(program, "dt");
+		world_location = rlGetLocationUniform(program, "world");
+		gravity_location = rlGetLocationUniform(program, "gravity");
+		damping_location = rlGetLocationUniform(program, "damping");
+		wrap_location = rlGetLocationUniform(program, "wrapEnabled");
+		reset_location = rlGetLocationUniform(program, "resetPrevious");
+		alpha_location = rlGetLocationUniform(program, "alpha");
+		point_size_location = rlGetLocationUniform(program, "pointSize");
+		view_location = rlGetLocationUniform(program, "view");
+		TraceLog(LOG_INFO, "COMPUTE: Compute shader simulation available (OpenGL %d.%d)", major, minor);
+		return true;
+	}
+
+	void GpuSimulation::unload() {
+		for( auto* buffer : { &body_ssbo, &color_ssbo, &order_ssbo, &instance_ssbo } ) {
+			if( *buffer != 0 ) {
+				rlUnloadVertexBuffer(*buffer);
+			}
+			*buffer = 0;
+		}
+		if( program != 0 ) {
+			rlUnloadShaderProgram(program);
+		}
+		program = 0;
+		capacity = entity_count = active_count = circle_count = 0;
+		is_synced = false;
+	}
+
+	void GpuSimulation::queue_edits(const Input& input, const EntityStore& entities) {
+		if( input.changed(InputChange::scene) ) {
+			is_synced = false;
+		}
+		if( is_synced ) {
+			edits.queue(input, entities);
+		}
+	}
+
+	void GpuSimulation::step(const Input& input, const World& world, const AABB& view, EntityStore& entities, SimulationClock& clock, float frame_time) {
+		if( !is_synced || entity_count != entities.size() ) {
+			upload(entities);
+		}
+		else {
+			// Positions of edited entities stay as the GPU has them
+			for( const auto i : edits.edited ) {
+				const auto offset = static_cast<int>(i * sizeof(Body));
+				if( edits.changed(InputChange::velocity_x) || edits.changed(InputChange::velocity_y) ) {
+					const float velocity[] ={ entities.velocity_x[i], entities.velocity_y[i] };
+					rlUpdateVertexBuffer(body_ssbo, velocity, sizeof(velocity), offset + static_cast<int>(offsetof(Body, velocity_x)));
+				}
+				if( edits.changed(InputChange::scale) ) {
+					const float extent[] ={ entities.extent_x[i] * entities.scales[i], entities.extent_y[i] * entities.scales[i] };
+					rlUpdateVertexBuffer(body_ssbo, extent, sizeof(extent), offset + static_cast<int>(offsetof(Body, half_width)));
+				}
+				if( edits.changed(InputChange::color) ) {
+					const auto color = pack_color(entities.colors[i]);
+					rlUpdateVertexBuffer(color_ssbo, &color, sizeof(color), static_cast<int>(i * sizeof(color)));
+				}
+			}
+			for( const auto i : edits.spawned ) {
+				const auto body = make_body(entities, i);
+				const auto color = pack_color(entities.colors[i]);
+				rlUpdateVertexBuffer(body_ssbo, &body, sizeof(body), static_cast<int>(i * sizeof(Body)));
+				rlUpdateVertexBuffer(color_ssbo, &color, sizeof(color), static_cast<int>(i * sizeof(color)));
+			}
+			if( edits.changed(InputChange::is_active) || !edits.spawned.empty() ) {
+				upload_order(entities);
+			}
+		}
+		edits.clear();
+
+		auto steps = 0;
+		auto reset_previous = 0;
+		const auto step_seconds = 1.0 / std::max(input.tick_rate, 1.0f);
+		if( !input.simulate_enabled ) {
+			clock ={};
+		}
+		else {
+			if( !clock.is_running ) {
+				reset_previous = 1;
+				clock.is_running = true;
+			}
+			steps = clock.advance(step_seconds, input.max_catch_up_steps, frame_time);
+			is_stale = true;
+		}
+		alpha = clock.alpha;
+
+		if( active_count > 0 ) {
+			const auto active = static_cast<int>(active_count);
+			const auto circles = static_cast<int>(circle_count);
+			const auto dt = static_cast<float>(step_seconds);
+			const float bounds[] ={ static_cast<float>(world.width), static_cast<float>(world.height) };
+			const auto gravity = input.motion.gravity * dt;
+			const auto damping = std::exp(-input.motion.damping * dt);
+			const auto wrap = input.motion.wrap ? 1 : 0;
+			const auto point_size = input.lod.point_size / input.camera.zoom;
+			const float view_area[] ={ view.x, view.y, view.width, view.height };
+			rlEnableShader(program);
+			rlSetUniform(active_count_location, &active, RL_SHADER_UNIFORM_INT, 1);
+			rlSetUniform(circle_count_location, &circles, RL_SHADER_UNIFORM_INT, 1);
+			rlSetUniform(steps_location, &steps, RL_SHADER_UNIFORM_INT, 1);
+			rlSetUniform(dt_location, &dt, RL_SHADER_UNIFORM_FLOAT, 1);
+			rlSetUniform(world_location, bounds, RL_SHADER_UNIFORM_VEC2, 1);
+			rlSetUniform(gravity_location, &gravity, RL_SHADER_UNIFORM_FLOAT, 1);
+			rlSetUniform(damping_location, &damping, RL_SHADER_UNIFORM_FLOAT, 1);
+			rlSetUniform(wrap_location, &wrap, RL_SHADER_UNIFORM_INT, 1);
+			rlSetUniform(reset_location, &reset_previous, RL_SHADER_UNIFORM_INT, 1);
+			rlSetUniform(alpha_location, &alpha, RL_SHADER_UNIFORM_FLOAT, 1);
+			rlSetUniform(point_size_location, &point_size, RL_SHADER_UNIFORM_FLOAT, 1);
+			rlSetUniform(view_location, view_area, RL_SHADER_UNIFORM_VEC4, 1);
+			gl.bind_buffer_base(gl_shader_storage_buffer, 0, body_ssbo);
+			gl.bind_buffer_base(gl_shader_storage_buffer, 1, order_ssbo);
+			gl.bind_buffer_base(gl_shader_storage_buffer, 2, color_ssbo);
+			gl.bind_buffer_base(gl_shader_storage_buffer, 3, instance_ssbo);
+			gl.dispatch_compute(static_cast<unsigned int>((active_count + group_size - 1) / group_size), 1, 1);
+			// The instances are drawn from and the bodies may be read back next
+			gl.memory_barrier(gl_shader_storage_barrier_bit | gl_vertex_attrib_array_barrier_bit | gl_buffer_update_barrier_bit);
+			rlDisableShader();
+		}
+
+		if( are_nametags_shown(input) || input.is_box_selecting ) {
+			// A paused scene does not move, so it is only read back once
+			if( is_stale ) {
+				read_back(entities);
+			}
+		}
+		else {
+			read_back(entities, input.selection.indices);
+		}
+	}
+
+	void GpuSimulation::sync_to(EntityStore& entities) {
+		if( is_synced && is_stale && entity_count == entities.size() ) {
+			read_back(entities);
+		}
+	}
+
+	void GpuSimulation::stop(EntityStore& entities) {
+		if( is_synced && entity_count == entities.size() ) {
+			read_back(entities);
+		}
+		is_synced = false;
+		edits.clear();
+	}
+
+	std::size_t GpuSimulation::gpu_bytes() const {
+		return capacity * (sizeof(Body) + 2 * sizeof(std::uint32_t) + sizeof(ShapeInstance));
+	}
+
+	void GpuSimulation::upload(const EntityStore& entities) {
+		const auto count = entities.size();
+		if( count > capacity ) {
+			capacity = std::max<std::size_t>(grown_capacity(capacity, count), 1024);
+			for( auto* buffer : { &body_ssbo, &color_ssbo, &order_ssbo, &instance_ssbo } ) {
+				if( *buffer != 0 ) {
+					rlUnloadVertexBuffer(*buffer);
+				}
+			}
+			body_ssbo = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * sizeof(Body)), true);
+			color_ssbo = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * sizeof(std::uint32_t)), true);
+			order_ssbo = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * sizeof(std::uint32_t)), true);
+			instance_ssbo = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity * sizeof(ShapeInstance)), true);
+			rlDisableVertexBuffer();
+		}
+		entity_count = count;
+		is_synced = true;
+		is_stale = true;
+		if( count == 0 ) {
+			active_count = circle_count = 0;
+			return;
+		}
+		bodies.resize(count);
+		words.resize(count);
+		for( std::size_t i = 0; i < count; ++i ) {
+			bodies[i] = make_body(entities, i);
+			words[i] = pack_color(entities.colors[i]);
+		}
+		rlUpdateVertexBuffer(body_ssbo, bodies.data(), static_cast<int>(count * sizeof(Body)), 0);
+		rlUpdateVertexBuffer(color_ssbo, words.data(), static_cast<int>(count * sizeof(std::uint32_t)), 0);
+		upload_order(entities);
+	}
+
+	void GpuSimulation::upload_order(const EntityStore& entities) {
+		// Circles first, as the shader tells the shape type by position
+		const auto& circles = entities.active_groups[static_cast<std::size_t>(ShapeType::circle)];
+		const auto& rectangles = entities.active_groups[static_cast<std::size_t>(ShapeType::rectangle)];
+		words.assign(circles.begin(), circles.end());
+		words.insert(words.end(), rectangles.begin(), rectangles.end());
+		circle_count = circles.size();
+		active_count = words.size();
+		if( active_count > 0 ) {
+			rlUpdateVertexBuffer(order_ssbo, words.data(), static_cast<int>(active_count * sizeof(std::uint32_t)), 0);
+		}
+	}
+
+	void GpuSimulation::read_back(EntityStore& entities) {
+		if( entity_count == 0 ) {
+			return;
+		}
+		bodies.resize(entity_count);
+		rlEnableVertexBuffer(body_ssbo);
+		gl.get_buffer_sub_data(gl_array_buffer, 0, static_cast<std::ptrdiff_t>(entity_count * sizeof(Body)), bodies.data());
+		rlDisableVertexBuffer();
+		for( std::size_t i = 0; i < entity_count; ++i ) {
+			store_body(entities, i, bodies[i], alpha);
+		}
+		is_stale = false;
+	}
+
+	void GpuSimulation::read_back(EntityStore& entities, const std::vector<std::uint32_t>& indices) {
+		// Each read back stalls until the GPU is done, so one copy of the whole
+		// span beats one per entity
+		auto first = std::numeric_limits<std::uint32_t>::max();
+		auto last = std::uint32_t{ 0 };
+		for( const auto i : indices ) {
+			if( i < entity_count ) {
+				first = std::min(first, i);
+				last = std::max(last, i);
+			}
+		}
+		if( first > last ) {
+			return;
+		}
+		bodies.resize(last - first + 1);
+		rlEnableVertexBuffer(body_ssbo);
+		gl.get_buffer_sub_data(gl_array_buffer, static_cast<std::ptrdiff_t>(first * sizeof(Body)), static_cast<std::ptrdiff_t>(bodies.size() * sizeof(Body)), bodies.data());
+		rlDisableVertexBuffer();
+		for( const auto i : indices ) {
+			if( i < entity_count ) {
+				store_body(entities, i, bodies[i - first], alpha);
+			}
+		}
+	}
+
+	GpuSimulation::Body GpuSimulation::make_body(const EntityStore& entities, std::size_t i) {
+		return {
+			entities.position_x[i],
+			entities.position_y[i],
+			entities.velocity_x[i],
+			entities.velocity_y[i],
+			entities.previous_x[i],
+			entities.previous_y[i],
+			entities.extent_x[i] * entities.scales[i],
+			entities.extent_y[i] * entities.scales[i]
+		};
+	}
+
+	void GpuSimulation::store_body(EntityStore& entities, std::size_t i, const Body& body, float alpha) {
+		entities.position_x[i] = body.x;
+		entities.position_y[i] = body.y;
+		entities.velocity_x[i] = body.velocity_x;
+		entities.velocity_y[i] = body.velocity_y;
+		entities.previous_x[i] = body.previous_x;
+		entities.previous_y[i] = body.previous_y;
+		entities.render_x[i] = body.previous_x + (body.x - body.previous_x) * alpha;
+		entities.render_y[i] = body.previous_y + (body.y - body.previous_y) * alpha;
+	}
+
+	void SimulationPipeline::wait() {
+		auto lock = std::unique_lock{ mutex };
+		condition.wait(lock, [this] { return !is_pending; });
+	}
+
+	void SessionRecorder::begin(const Input& input, const EntityStore& entities, const World& world) {
+		header = SessionHeader{};
+		header.world_width = world.width;
+		header.world_height = world.height;
+		write_snapshot(entities, initial_state);
+		events.clear();
+		settings = capture_settings(input);
+		recording = true;
+		// Replay starts from the selection and settings in effect now
+		append_record(input, entities, static_cast<std::uint32_t>(InputChange::selection) | session_settings_changed);
+	}
+
+	void SessionRecorder::record(const Input& input, const EntityStore& entities) {
+		if( !recording ) {
+			return;
+		}
+		// Camera and drawing-only changes are not replayed, but drawing toggles are
+		// caught by the settings comparison
+		constexpr auto recorded = ~static_cast<std::uint32_t>(InputChange::view);
+		auto flags = input.changes & recorded;
+		// Spawns are replayed by restoring a snapshot of the store after them
+		if( input.changed(InputChange::spawn) ) {
+			flags = (flags & ~static_cast<std::uint32_t>(InputChange::spawn)) | static_cast<std::uint32_t>(InputChange::scene);
+		}
+		if( const auto current = capture_settings(input); current != settings ) {
+			settings = current;
+			flags |= session_settings_changed;
+		}
+		if( flags != 0 ) {
+			append_record(input, entities, flags);
+		}
+		++header.frame_count;
+	}
+
+	void SessionRecorder::append_record(const Input& input, const EntityStore& entities, std::uint32_t flags) {
+		const auto append = [&](const void* data, std::size_t bytes) {
+			const auto* first = static_cast<const char*>(data);
+			events.insert(events.end(), first, first + bytes);
+		};
+		const auto append_value = [&](auto value) { append(&value, sizeof(value)); };
+		const auto has = [&](InputChange change) { return (flags & static_cast<std::uint32_t>(change)) != 0; };
+		append_value(header.frame_count);
+		append_value(flags);
+		if( has(InputChange::selection) ) {
+			const auto& indices = input.selection.indices;
+			append_value(input.selected.index);
+			append_value(static_cast<std::uint32_t>(indices.size()));
+			append(indices.data(), indices.size() * sizeof(indices[0]));
+		}
+		if( has(InputChange::is_active) ) {
+			append_value(static_cast<std::uint8_t>(input.is_active));
+		}
+		if( has(InputChange::scale) ) {
+			append_value(input.scale);
+		}
+		if( has(InputChange::velocity_x) ) {
+			append_value(input.velocity[0]);
+		}
+		if( has(InputChange::velocity_y) ) {
+			append_value(input.velocity[1]);
+		}
+		if( has(InputChange::color) ) {
+			append(input.color, sizeof(input.color));
+		}
+		if( has(InputChange::name) ) {
+			append_value(static_cast<std::uint32_t>(input.name.size()));
+			append(input.name.data(), input.name.size());
+		}
+		if( has(InputChange::scene) ) {
+			write_snapshot(entities, scene);
+			append_value(static_cast<std::uint32_t>(scene.size()));
+			append(scene.data(), scene.size());
+		}
+		if( (flags & session_settings_changed) != 0 ) {
+			append_value(settings);
+		}
+	}
+
+	bool SessionRecorder::end(const std::filesystem::path& path) {
+		recording = false;
+		header.state_bytes = static_cast<std::uint32_t>(initial_state.size());
+		header.event_bytes = static_cast<std::uint32_t>(events.size());
+		auto output = std::ofstream{ path, std::ios::binary };
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(initial_state.data(), static_cast<std::streamsize>(initial_state.size()));
+		output.write(events.data(), static_cast<std::streamsize>(events.size()));
+		return static_cast<bool>(output);
+	}
+
+	bool SessionPlayer::load(const std::filesystem::path& path) {
+		const auto file = MappedFile{ path };
+		const auto text = file.text();
+		if( !file.is_open() || text.size() < sizeof(header) ) {
+			return false;
+		}
+		std::memcpy(&header, text.data(), sizeof(header));
+		if( header.magic != SessionHeader{}.magic || header.version != SessionHeader{}.version
+			|| text.size() != sizeof(header) + std::size_t{ header.state_bytes } + header.event_bytes ) {
+			return false;
+		}
+		data.assign(text.begin(), text.end());
+		// Check the starting scene now rather than on the first restart
+		auto entities = EntityStore{};
+		return restart(entities);
+	}
+
+	bool SessionPlayer::restart(EntityStore& entities) {
+		next = sizeof(header) + header.state_bytes;
+		frame = 0;
+		return data.size() >= next && restore_snapshot({ data.data() + sizeof(header), header.state_bytes }, entities);
+	}
+
+	bool SessionPlayer::apply(Input& input, EntityStore& entities) {
+		auto is_valid = true;
+		const auto read = [&](void* value, std::size_t bytes) {
+			if( data.size() - next < bytes ) {
+				is_valid = false;
+				return;
+			}
+			std::memcpy(value, data.data() + next, bytes);
+			next += bytes;
+		};
+		const auto read_value = [&](auto& value) { read(&value, sizeof(value)); };
+		while( is_valid && next < data.size() ) {
+			std::uint32_t record_frame = 0;
+			std::uint32_t flags = 0;
+			if( data.size() - next < sizeof(record_frame) + sizeof(flags) ) {
+				return false;
+			}
+			std::memcpy(&record_frame, data.data() + next, sizeof(record_frame));
+			if( record_frame != frame ) {
+				break;
+			}
+			next += sizeof(record_frame);
+			read_value(flags);
+			const auto has = [&](InputChange change) { return (flags & static_cast<std::uint32_t>(change)) != 0; };
+			if( has(InputChange::selection) ) {
+				std::uint32_t primary = 0;
+				std::uint32_t count = 0;
+				read_value(primary);
+				read_value(count);
+				input.selected = primary < entities.size() ? entities.handle(primary) : EntityHandle{ primary };
+				if( !is_valid || (data.size() - next) / sizeof(std::uint32_t) < count ) {
+					return false;
+				}
+				input.selection.resize(entities.size());
+				input.selection.clear();
+				for( std::uint32_t k = 0; k < count; ++k ) {
+					std::uint32_t i = 0;
+					read_value(i);
+					if( i < entities.size() ) {
+						input.selection.add(i);
+					}
+				}
+			}
+			if( has(InputChange::is_active) ) {
+				std::uint8_t is_active = 0;
+				read_value(is_active);
+				input.is_active = is_active != 0;
+			}
+			if( has(InputChange::scale) ) {
+				read_value(input.scale);
+			}
+			if( has(InputChange::velocity_x) ) {
+				read_value(input.velocity[0]);
+			}
+			if( has(InputChange::velocity_y) ) {
+				read_value(input.velocity[1]);
+			}
+			if( has(InputChange::color) ) {
+				read(input.color, sizeof(input.color));
+			}
+			if( has(InputChange::name) ) {
+				std::uint32_t length = 0;
+				read_value(length);
+				if( !is_valid || data.size() - next < length ) {
+					return false;
+				}
+				input.name.assign(data.data() + next, length);
+				next += length;
+			}
+			if( has(InputChange::scene) ) {
+				std::uint32_t length = 0;
+				read_value(length);
+				if( !is_valid || data.size() - next < length || !restore_snapshot({ data.data() + next, length }, entities) ) {
+					return false;
+				}
+				next += length;
+			}
+			if( (flags & session_settings_changed) != 0 ) {
+				auto settings = SessionSettings{};
+				read_value(settings);
+				apply_settings(settings, input);
+			}
+			input.changes |= flags & ~session_settings_changed;
+		}
+		++frame;
+		return is_valid;
+	}
+
+	SceneLoader::~SceneLoader() {
+		stop();
+	}
+
+	void SceneLoader::start(std::filesystem::path config_path, SceneSource source, TextRenderer& text_renderer) {
+		stop();
+		this->config_path = std::move(config_path);
+		this->source = std::move(source);
+		this->text_renderer = &text_renderer;
+		has_header = is_font_pending = is_finished = is_stopping = false;
+		failure = nullptr;
+		batches.clear();
+		parsed_bytes = total_bytes = 0;
+		worker = std::thread{ &SceneLoader::run, this };
+	}
+
+	bool SceneLoader::wait_for_header(Config& config) {
+		auto lock = std::unique_lock{ mutex };
+		condition.wait(lock, [this] { return has_header; });
+		if( failure != nullptr ) {
+			return false;
+		}
+		config.window = header.window;
+		config.world = header.world;
+		config.has_world = header.has_world;
+		config.font_asset = header.font_asset;
+		return true;
+	}
+
+	bool SceneLoader::take_font() {
+		const auto lock = std::lock_guard{ mutex };
+		return std::exchange(is_font_pending, false);
+	}
+
+	std::size_t SceneLoader::poll(EntityStore& templates, EntityStore& entities) {
+		auto taken = std::vector<EntityStore>{};
+		{
+			const auto lock = std::lock_guard{ mutex };
+			const auto count = static_cast<std::ptrdiff_t>(std::min(batches.size(), batches_per_poll));
+			taken.assign(std::make_move_iterator(batches.begin()), std::make_move_iterator(batches.begin() + count));
+			batches.erase(batches.begin(), batches.begin() + count);
+		}
+		auto added = std::size_t{ 0 };
+		for( auto& batch : taken ) {
+			added += batch.size();
+			if( templates.size() == 0 && entities.size() == 0 ) {
+				templates = std::move(batch);
+				entities = templates;
+			}
+			else {
+				templates.append(batch);
+				entities.append(batch);
+			}
+		}
+		return added;
+	}
+
+	bool SceneLoader::is_loading() const {
+		const auto lock = std::lock_guard{ mutex };
+		return failure == nullptr && (!is_finished || !batches.empty());
+	}
+
+	const char* SceneLoader::error() const {
+		const auto lock = std::lock_guard{ mutex };
+		return failure;
+	}
+
+	float SceneLoader::progress() const {
+		const auto lock = std::lock_guard{ mutex };
+		if( is_finished ) {
+			return 1.0f;
+		}
+		return total_bytes == 0 ? 0.0f : static_cast<float>(parsed_bytes) / static_cast<float>(total_bytes);
+	}
+
+	void SceneLoader::stop() {
+		{
+			const auto lock = std::lock_guard{ mutex };
+			is_stopping = true;
+		}
+		if( worker.joinable() ) {
+			worker.join();
+		}
+	}
+
+	void SceneLoader::run() {
+		A1_MEMORY_SCOPE(MemoryTag::config);
+		auto error = std::error_code{};
+		if( !std::filesystem::is_regular_file(config_path, error) ) {
+			fail("Failed to read configuration file.");
+			return;
+		}
+		watcher = ConfigWatcher{ config_path };
+		const auto text = watcher.applied();
+		auto config = Config{};
+		if( !parse_config_header(text, config) ) {
+			fail("Failed to read configuration file.");
+			return;
+		}
+		{
+			const auto lock = std::lock_guard{ mutex };
+			header = config;
+			has_header = true;
+			total_bytes = text.size();
+		}
+		condition.notify_all();
+
+		text_renderer->prepare(config.font_asset.file);
+		{
+			const auto lock = std::lock_guard{ mutex };
+			is_font_pending = true;
+		}
+
+		if( source.generate || !source.snapshot.empty() ) {
+			auto scene = EntityStore{};
+			if( source.generate ) {
+				generate_entities(scene, source.generator, config.world, 0);
+			}
+			else if( !load_snapshot(source.snapshot, scene) ) {
+				fail("Failed to load snapshot file.");
+				return;
+			}
+			publish(std::move(scene), text.size());
+		}
+		else {
+			// Batches end at line breaks, as each entity takes a line
+			for( std::size_t first = 0; first < text.size(); ) {
+				auto last = first;
+				for( std::size_t lines = 0; lines < batch_size && last < text.size(); ++lines ) {
+					last = std::min(text.find('\n', last), text.size() - 1) + 1;
+				}
+				auto batch = Config{};
+				if( !parse_config(text.substr(first, last - first), batch) ) {
+					fail("Failed to read configuration file.");
+					return;
+				}
+				if( !publish(std::move(batch.entity_templates), last) ) {
+					return;
+				}
+				first = last;
+			}
+		}
+		const auto lock = std::lock_guard{ mutex };
+		is_finished = true;
+	}
+
+	bool SceneLoader::publish(EntityStore&& batch, std::size_t bytes) {
+		const auto lock = std::lock_guard{ mutex };
+		if( batch.size() > 0 ) {
+			batches.push_back(std::move(batch));
+		}
+		parsed_bytes = bytes;
+		return !is_stopping;
+	}
+
+	void SceneLoader::fail(const char* message) {
+		{
+			const auto lock = std::lock_guard{ mutex };
+			failure = message;
+			// Wakes a main thread still waiting for the header
+			has_header = is_finished = true;
+		}
+		condition.notify_all();
+	}
+
+	std::istream& operator >>(std::istream& input, Config& obj) {
+		const auto text = std::string{ std::istreambuf_iterator<char>{ input }, std::istreambuf_iterator<char>{} };
+		if( !parse_config(text, obj) ) {
+			input.setstate(std::ios::failbit);
+		}
+		return input;
+	}
+
+	void apply_settings(const SessionSettings& settings, Input& input) {
+		input.simulate_enabled = settings.simulate_enabled != 0;
+		input.parallel_enabled = settings.parallel_enabled != 0;
+		input.collide_enabled = settings.collide_enabled != 0;
+		input.draw_shapes_enabled = settings.draw_shapes_enabled != 0;
+		input.draw_text_enabled = settings.draw_text_enabled != 0;
+		input.instancing_enabled = settings.instancing_enabled != 0;
+		input.motion.wrap = settings.wrap_enabled != 0;
+		input.motion.gravity = settings.gravity;
+		input.motion.damping = settings.damping;
+		input.thread_count = settings.thread_count;
+		input.min_chunk_size = settings.min_chunk_size;
+		input.max_catch_up_steps = settings.max_catch_up_steps;
+		input.tick_rate = settings.tick_rate;
+		input.text_size = settings.text_size;
+	}
+
+	SessionSettings capture_settings(const Input& input) {
+		auto settings = SessionSettings{};
+		settings.simulate_enabled = input.simulate_enabled;
+		settings.parallel_enabled = input.parallel_enabled;
+		settings.collide_enabled = input.collide_enabled;
+		settings.draw_shapes_enabled = input.draw_shapes_enabled;
+		settings.draw_text_enabled = input.draw_text_enabled;
+		settings.instancing_enabled = input.instancing_enabled;
+		settings.wrap_enabled = input.motion.wrap;
+		settings.gravity = input.motion.gravity;
+		settings.damping = input.motion.damping;
+		settings.thread_count = input.thread_count;
+		settings.min_chunk_size = input.min_chunk_size;
+		settings.max_catch_up_steps = input.max_catch_up_steps;
+		settings.tick_rate = input.tick_rate;
+		settings.text_size = input.text_size;
+		return settings;
+	}
+
+	void change_selection(Input& input, const EntityStore& entities) {
+		if( !entities.contains(input.selected) ) {
+			return;
+		}
+		const auto i = input.selected.index;
+		input.is_active = entities.is_active[i];
+		input.scale = entities.scales[i];
+		input.velocity[0] = entities.velocity_x[i];
+		input.velocity[1] = entities.velocity_y[i];
+		input.color[0] = entities.colors[i].r;
+		input.color[1] = entities.colors[i].g;
+		input.color[2] = entities.colors[i].b;
+		input.name = entities.name(i);
+	}
+
+	int circle_segments(float radius, const LevelOfDetail& lod) {
+		const auto circumference = 2 * std::numbers::pi_v<float> * radius;
+		return std::clamp(static_cast<int>(std::ceil(circumference / std::max(lod.segment_length, 1.0f))), 6, 96);
+	}
+
+	bool collide(EntityStore& entities, std::uint32_t a, std::uint32_t b) {
+		const auto circle_a = entities.shape_types[a] == ShapeType::circle;
+		const auto circle_b = entities.shape_types[b] == ShapeType::circle;
+		const auto half_width_a = entities.extent_x[a] * entities.scales[a];
+		const auto half_height_a = entities.extent_y[a] * entities.scales[a];
+		const auto half_width_b = entities.extent_x[b] * entities.scales[b];
+		const auto half_height_b = entities.extent_y[b] * entities.scales[b];
+		const auto dx = entities.position_x[b] - entities.position_x[a];
+		const auto dy = entities.position_y[b] - entities.position_y[a];
+
+		// Find the contact normal (from a to b) and penetration depth
+		auto normal_x = 1.0f;
+		auto normal_y = 0.0f;
+		auto depth = 0.0f;
+		// Picks the axis of least penetration between two boxes
+		const auto box_contact = [&](float overlap_x, float overlap_y) {
+			if( overlap_x <= 0.0f || overlap_y <= 0.0f ) {
+				return false;
+			}
+			if( overlap_x < overlap_y ) {
+				normal_x = dx < 0.0f ? -1.0f : 1.0f;
+				normal_y = 0.0f;
+				depth = overlap_x;
+			}
+			else {
+				normal_x = 0.0f;
+				normal_y = dy < 0.0f ? -1.0f : 1.0f;
+				depth = overlap_y;
+			}
+			return true;
+		};
+		if( circle_a && circle_b ) {
+			const auto radii = half_width_a + half_width_b;
+			const auto distance_squared = dx * dx + dy * dy;
+			if( distance_squared >= radii * radii ) {
+				return false;
+			}
+			const auto distance = std::sqrt(distance_squared);
+			if( distance > 0.0f ) {
+				normal_x = dx / distance;
+				normal_y = dy / distance;
+			}
+			depth = radii - distance;
+		}
+		else if( !circle_a && !circle_b ) {
+			if( !box_contact(half_width_a + half_width_b - std::abs(dx), half_height_a + half_height_b - std::abs(dy)) ) {
+				return false;
+			}
+		}
+		else {
+			// Circle against rectangle, worked in the rectangle's frame
+			const auto sign = circle_a ? -1.0f : 1.0f;
+			const auto radius = circle_a ? half_width_a : half_width_b;
+			const auto half_width = circle_a ? half_width_b : half_width_a;
+			const auto half_height = circle_a ? half_height_b : half_height_a;
+			// Circle centre relative to the rectangle centre
+			const auto cx = sign * dx;
+			const auto cy = sign * dy;
+			const auto closest_x = std::clamp(cx, -half_width, half_width);
+			const auto closest_y = std::clamp(cy, -half_height, half_height);
+			const auto offset_x = cx - closest_x;
+			const auto offset_y = cy - closest_y;
+			const auto distance_squared = offset_x * offset_x + offset_y * offset_y;
+			if( distance_squared >= radius * radius ) {
+				return false;
+			}
+			if( distance_squared > 0.0f ) {
+				const auto distance = std::sqrt(distance_squared);
+				// Normal from rectangle to circle, flipped to point from a to b
+				normal_x = sign * offset_x / distance;
+				normal_y = sign * offset_y / distance;
+				depth = radius - distance;
+			}
+			// Centre inside the rectangle: push out along the shallowest axis
+			else if( !box_contact(half_width + radius - std::abs(cx), half_height + radius - std::abs(cy)) ) {
+				return false;
+			}
+		}
+
+		// Mass proportional to area; only the ratio matters for the response
+		const auto mass = [&](bool is_circle, float half_width, float half_height) {
+			return is_circle ? std::numbers::pi_v<float> * half_width * half_width : 4.0f * half_width * half_height;
+		};
+		const auto inverse_mass_a = 1.0f / std::max(mass(circle_a, half_width_a, half_height_a), 1e-6f);
+		const auto inverse_mass_b = 1.0f / std::max(mass(circle_b, half_width_b, half_height_b), 1e-6f);
+		const auto inverse_mass_sum = inverse_mass_a + inverse_mass_b;
+
+		// Separate the shapes so they don't stay interlocked over several ticks
+		const auto correction = depth / inverse_mass_sum;
+		entities.position_x[a] -= normal_x * correction * inverse_mass_a;
+		entities.position_y[a] -= normal_y * correction * inverse_mass_a;
+		entities.position_x[b] += normal_x * correction * inverse_mass_b;
+		entities.position_y[b] += normal_y * correction * inverse_mass_b;
+
+		// Elastic impulse, only while the shapes are approaching
+		const auto approach_speed =
+			(entities.velocity_x[b] - entities.velocity_x[a]) * normal_x
+			+ (entities.velocity_y[b] - entities.velocity_y[a]) * normal_y;
+		if( approach_speed < 0.0f ) {
+			const auto impulse = -2.0f * approach_speed / inverse_mass_sum;
+			entities.velocity_x[a] -= impulse * inverse_mass_a * normal_x;
+			entities.velocity_y[a] -= impulse * inverse_mass_a * normal_y;
+			entities.velocity_x[b] += impulse * inverse_mass_b * normal_x;
+			entities.velocity_y[b] += impulse * inverse_mass_b * normal_y;
+		}
+		return true;
+	}
+
+	std::size_t count_allocations() {
+		auto count = std::size_t{ 0 };
+		for( std::size_t tag = 0; tag < memory_tag_count; ++tag ) {
+			count += memory_usage(static_cast<MemoryTag>(tag)).allocations;
+		}
+		return count;
+	}
+
+	std::size_t draw_names(const Input& input, const EntityStore& entities, const Font& font, const AABB& view) {
+		const auto color = ColorFromNormalized({ input.text_color[0], input.text_color[1], input.text_color[2], 1.0f });
+		std::size_t draw_calls = 0;
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				const auto width = entities.name_width[entities.names[i]];
+				const auto height = entities.name_height[entities.names[i]];
+				const auto tag = AABB{ entities.render_x[i] - width / 2, entities.render_y[i] - height / 2, width, height };
+				if( !intersects(tag, view) ) {
+					continue;
+				}
+				DrawTextEx(
+					font,
+					entities.name(i),
+					{ tag.x, tag.y },
+					input.text_size,
+					1.0f,
+					color
+				);
+				++draw_calls;
+			}
+		}
+		return draw_calls;
+	}
+
+	std::size_t draw_selection(const Input& input, const EntityStore& entities, const AABB& view) {
+		// Outlines keep the same on-screen thickness and margin at any zoom
+		const auto pixel = 1.0f / input.camera.zoom;
+		std::size_t draw_calls = 0;
+		for( const auto i : input.selection.indices ) {
+			if( !entities.is_active[i] || !intersects(render_aabb(entities, i), view) ) {
+				continue;
+			}
+			const auto half_width = entities.extent_x[i] * entities.scales[i] + 3.0f * pixel;
+			const auto half_height = entities.extent_y[i] * entities.scales[i] + 3.0f * pixel;
+			DrawRectangleLinesEx({ entities.render_x[i] - half_width, entities.render_y[i] - half_height, 2 * half_width, 2 * half_height }, pixel, ::Color{ 255, 255, 255, 192 });
+			++draw_calls;
+		}
+		if( input.is_box_selecting ) {
+			const auto box = ::Rectangle{
+				std::min(input.box_start[0], input.box_end[0]),
+				std::min(input.box_start[1], input.box_end[1]),
+				std::abs(input.box_end[0] - input.box_start[0]),
+				std::abs(input.box_end[1] - input.box_start[1])
+			};
+			DrawRectangleRec(box, ::Color{ 255, 255, 255, 32 });
+			DrawRectangleLinesEx(box, pixel, ::Color{ 255, 255, 255, 192 });
+			draw_calls += 2;
+		}
+		return draw_calls;
+	}
+
+	std::size_t draw_shapes(const Input& input, const EntityStore& entities, const AABB& view) {
+		std::size_t draw_calls = 0;
+		const auto zoom = input.camera.zoom;
+		const auto point_extent = input.lod.point_size / (2 * zoom);
+		// Each shape type is drawn in its own non-virtual loop
+		for( const auto i : entities.active_groups[static_cast<std::size_t>(ShapeType::circle)] ) {
+			if( !intersects(render_aabb(entities, i), view) ) {
+				continue;
+			}
+			const auto radius = entities.extent_x[i] * entities.scales[i];
+			if( radius < point_extent ) {
+				DrawRectangleV(
+					{ entities.render_x[i] - radius, entities.render_y[i] - radius },
+					{ 2 * radius, 2 * radius },
+					ColorFromNormalized({ entities.colors[i].r, entities.colors[i].g, entities.colors[i].b, entities.colors[i].a })
+				);
+			}
+			else {
+				Circle{ entities.extent_x[i] }.draw(
+					{ entities.render_x[i], entities.render_y[i] },
+					entities.scales[i],
+					entities.colors[i],
+					circle_segments(radius * zoom, input.lod)
+				);
+			}
+			++draw_calls;
+		}
+		for( const auto i : entities.active_groups[static_cast<std::size_t>(ShapeType::rectangle)] ) {
+			if( !intersects(render_aabb(entities, i), view) ) {
+				continue;
+			}
+			Rectangle{ 2 * entities.extent_x[i], 2 * entities.extent_y[i] }.draw(
+				{ entities.render_x[i], entities.render_y[i] },
+				entities.scales[i],
+				entities.colors[i]
+			);
+			++draw_calls;
+		}
+		return draw_calls;
+	}
+
+	AABB entity_aabb(const EntityStore& entities, std::size_t i) {
+		const auto half_width = entities.extent_x[i] * entities.scales[i];
+		const auto half_height = entities.extent_y[i] * entities.scales[i];
+		return {
+			entities.position_x[i] - half_width,
+			entities.position_y[i] - half_height,
+			2 * half_width,
+			2 * half_height
+		};
+	}
+
+	void generate_entities(EntityStore& entities, const GeneratorSettings& settings, const World& world, int thread_count) {
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		const auto count = static_cast<std::size_t>(std::max(settings.count, 0));
+		entities.clear();
+		// Names are C or R and up to 7 digits for the first ten million entities
+		entities.reserve(count, count * 8);
+		const auto resize = [count](auto&... components) { (components.resize(count), ...); };
+		resize(
+			entities.position_x, entities.position_y, entities.previous_x, entities.previous_y,
+			entities.render_x, entities.render_y, entities.velocity_x, entities.velocity_y,
+			entities.scales, entities.colors, entities.shape_types, entities.extent_x,
+			entities.extent_y, entities.is_active, entities.generations
+		);
+
+		// SplitMix64 of the seed, entity index and draw number gives a uniform
+		// value in [0, 1) without any generator state shared between threads
+		const auto key = static_cast<std::uint64_t>(settings.seed) << 40;
+		const auto random = [key](std::size_t i, std::uint64_t draw) {
+			auto z = key + i * 16 + draw + 0x9e3779b97f4a7c15ull;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			z ^= z >> 31;
+			return static_cast<float>(z >> 40) * 0x1.0p-24f;
+		};
+		const auto lerp = [](float low, float high, float t) { return low + (high - low) * t; };
+		const auto place = [](float extent, float size, float t) {
+			return extent * 2 < size ? extent + (size - 2 * extent) * t : size / 2;
+		};
+		const auto width = static_cast<float>(world.width);
+		const auto height = static_cast<float>(world.height);
+		const auto last = static_cast<long long>(count);
+#if defined(_OPENMP)
+		const auto threads = thread_count > 0 ? thread_count : omp_get_max_threads();
+		#pragma omp parallel for num_threads(threads) schedule(static)
+#else
+		static_cast<void>(thread_count);
+#endif
+		for( long long n = 0; n < last; ++n ) {
+			const auto i = static_cast<std::size_t>(n);
+			const auto is_circle = random(i, 0) < settings.circle_fraction;
+			const auto half_width = lerp(settings.min_extent, settings.max_extent, random(i, 1));
+			const auto half_height = is_circle ? half_width : lerp(settings.min_extent, settings.max_extent, random(i, 2));
+			const auto x = place(half_width, width, random(i, 3));
+			const auto y = place(half_height, height, random(i, 4));
+			const auto speed = lerp(settings.min_speed, settings.max_speed, random(i, 5));
+			const auto angle = 2 * std::numbers::pi_v<float> * random(i, 6);
+			entities.position_x[i] = entities.previous_x[i] = entities.render_x[i] = x;
+			entities.position_y[i] = entities.previous_y[i] = entities.render_y[i] = y;
+			entities.velocity_x[i] = speed * std::cos(angle);
+			entities.velocity_y[i] = speed * std::sin(angle);
+			entities.scales[i] = 1.0f;
+			entities.colors[i] ={
+				lerp(settings.min_color[0], settings.max_color[0], random(i, 7)),
+				lerp(settings.min_color[1], settings.max_color[1], random(i, 8)),
+				lerp(settings.min_color[2], settings.max_color[2], random(i, 9))
+			};
+			entities.shape_types[i] = is_circle ? ShapeType::circle : ShapeType::rectangle;
+			entities.extent_x[i] = half_width;
+			entities.extent_y[i] = half_height;
+			entities.is_active[i] = 1;
+		}
+
+		// Every generated name is unique, so name i gets ID i and the table is
+		// indexed once at the end
+		auto& table = entities.name_table;
+		entities.names.resize(count);
+		char name[16];
+		for( std::size_t i = 0; i < count; ++i ) {
+			const auto type = entities.shape_types[i];
+			name[0] = type == ShapeType::circle ? 'C' : 'R';
+			const auto end = std::to_chars(name + 1, name + sizeof(name), i).ptr;
+			entities.names[i] = table.append_unindexed({ name, static_cast<std::size_t>(end - name) });
+			entities.shape_groups[static_cast<std::size_t>(type)].push_back(static_cast<std::uint32_t>(i));
+		}
+		table.reindex();
+		entities.name_width.assign(count, 0.0f);
+		entities.name_height.assign(count, 0.0f);
+		entities.stale_names.resize(count);
+		std::iota(entities.stale_names.begin(), entities.stale_names.end(), NameId{ 0 });
+		entities.update_active_set();
+	}
+
+	void handle_all_shape_controls_ui(Input& input) {
+		ImGui::SeparatorText("All Shape Controls");
+		if( ImGui::Checkbox("Draw Shapes", &input.draw_shapes_enabled) ) {
+			input.mark(InputChange::view);
+		}
+		ImGui::SameLine();
+		if( ImGui::Checkbox("Draw Text", &input.draw_text_enabled) ) {
+			input.mark(InputChange::view);
+		}
+		ImGui::SameLine();
+		ImGui::Checkbox("Simulate", &input.simulate_enabled);
+		ImGui::SameLine();
+		ImGui::Checkbox("Parallel", &input.parallel_enabled);
+		ImGui::Checkbox("Collide", &input.collide_enabled);
+		ImGui::SameLine();
+		ImGui::Checkbox("Pipelined", &input.pipeline_enabled);
+		ImGui::SameLine();
+		if( ImGui::Checkbox("Instanced Rendering", &input.instancing_enabled) ) {
+			input.mark(InputChange::view);
+		}
+		// Collisions only run on the CPU, so they keep the simulation there
+		ImGui::BeginDisabled(!input.gpu_available);
+		ImGui::Checkbox("GPU Compute", &input.gpu_enabled);
+		ImGui::EndDisabled();
+		if( !input.gpu_available && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled) ) {
+			ImGui::SetTooltip("Needs OpenGL 4.3");
+		}
+		else if( input.gpu_enabled && input.collide_enabled && ImGui::IsItemHovered() ) {
+			ImGui::SetTooltip("Collisions run on the CPU");
+		}
+		else if( input.gpu_available && ImGui::IsItemHovered() ) {
+			ImGui::SetTooltip("Shown nametags and box selection copy every position back from the GPU each frame");
+		}
+		ImGui::SameLine();
+		ImGui::Checkbox("Cache Paused Scene", &input.scene_cache_enabled);
+		ImGui::SameLine();
+		if( ImGui::Button("Reset View") ) {
+			input.camera ={ { 0.0f, 0.0f }, { 0.0f, 0.0f }, 0.0f, 1.0f };
+			input.mark(InputChange::view);
+		}
+		if( ImGui::SliderFloat("Point Size", &input.lod.point_size, 0.0f, 16.0f, "%.1f px") ) {
+			input.mark(InputChange::view);
+		}
+		if( ImGui::SliderFloat("Segment Length", &input.lod.segment_length, 1.0f, 32.0f, "%.1f px") ) {
+			input.mark(InputChange::view);
+		}
+		if( input.parallel_enabled ) {
+#if defined(_OPENMP)
+			const auto max_threads = omp_get_num_procs();
+#else
+			const auto max_threads = 1;
+#endif
+			ImGui::SliderInt("Threads", &input.thread_count, 0, max_threads, input.thread_count == 0 ? "All" : "%d");
+			ImGui::InputInt("Min Chunk", &input.min_chunk_size, 1024, 16384);
+			input.min_chunk_size = std::max(input.min_chunk_size, 1);
+		}
+		const char* edges[] ={ "Bounce", "Wrap" };
+		auto edge = input.motion.wrap ? 1 : 0;
+		if( ImGui::Combo("Edges", &edge, edges, IM_ARRAYSIZE(edges)) ) {
+			input.motion.wrap = edge == 1;
+		}
+		ImGui::SliderFloat("Gravity", &input.motion.gravity, -1000.0f, 1000.0f, "%.0f px/s^2");
+		ImGui::SliderFloat("Damping", &input.motion.damping, 0.0f, 5.0f, "%.2f /s");
+		ImGui::SliderFloat("Tick Rate", &input.tick_rate, 10.0f, 240.0f, "%.0f Hz");
+		ImGui::SliderInt("Max Catch-up", &input.max_catch_up_steps, 1, 20, "%d ticks");
+		if( ImGui::SliderInt("Target FPS", &input.target_fps, 0, 240, input.target_fps == 0 ? "Uncapped" : "%d") ) {
+			SetTargetFPS(input.target_fps);
+		}
+	}
+
+	void handle_input(Input& input, EntityStore& entities) {
+		// A store of a different size (e.g. a loaded snapshot) invalidates the selection
+		if( input.selection.is_selected.size() != entities.size() ) {
+			input.selection.resize(entities.size());
+			input.filter_dirty = true;
+			if( entities.contains(input.selected) ) {
+				select_entity(input, input.selected, false);
+			}
+		}
+		if( input.changed(InputChange::name) ) {
+			input.filter_dirty = true;
+		}
+		if( entities.contains(input.selected) ) {
+			if( input.changed(InputChange::selection) ) {
+				change_selection(input, entities);
+			}
+			else {
+				update_selection(input, entities);
+			}
+		}
+		input.changes = 0;
+	}
+
+	std::size_t handle_rendering(const Input& input, const Font& font, const FontAsset& font_asset, const EntityStore& entities, ShapeRenderer& shape_renderer, TextRenderer& text_renderer, const GpuSimulation& gpu_simulation, const AABB& view) {
+		std::size_t draw_calls = 0;
+		// Shapes are drawn in one pass and names in a second so each loop only
+		// streams the component arrays it needs; names always end up on top
+		if( input.draw_shapes_enabled ) {
+			const auto point_size = input.lod.point_size / input.camera.zoom;
+			// The store's positions lag behind the GPU's while it simulates
+			if( gpu_simulation.is_running() && shape_renderer.is_ready() ) {
+				draw_calls += shape_renderer.draw_buffer(gpu_simulation.instance_buffer(), gpu_simulation.instance_count());
+			}
+			else if( input.instancing_enabled && shape_renderer.is_ready() ) {
+				if( input.parallel_enabled ) {
+					draw_calls += shape_renderer.draw_parallel(entities, view, point_size, input.thread_count, static_cast<std::size_t>(input.min_chunk_size));
+				}
+				else {
+					draw_calls += shape_renderer.draw(entities, view, point_size);
+				}
+			}
+			else {
+				draw_calls += draw_shapes(input, entities, view);
+			}
+		}
+		if( are_nametags_shown(input) ) {
+			// The distance field atlas needs its shader, so raylib's text drawing
+			// is only used with the bitmap font loaded when the atlas is unavailable
+			if( text_renderer.is_ready() ) {
+				draw_calls += text_renderer.draw(input, entities, view);
+			}
+			else if( font.texture.id != 0 ) {
+				draw_calls += draw_names(input, entities, font, view);
+			}
+		}
+		draw_calls += draw_selection(input, entities, view);
+		return draw_calls;
+	}
+
+	void handle_reset_ui(Input& input, std::string_view initial_state, EntityStore& entities, const FontAsset& font_asset, GpuSimulation& gpu_simulation) {
+		ImGui::SeparatorText("");
+		if( ImGui::Button("Reset") ) {
+			restore_snapshot(initial_state, entities);
+			input.draw_shapes_enabled = true;
+			input.draw_text_enabled = true;
+			input.simulate_enabled = true;
+			input.changes = 0;
+			initialize_ui(input, entities, font_asset);
+		}
+		constexpr auto snapshot_path = "snapshot.a1s";
+		ImGui::SameLine();
+		if( ImGui::Button("Save Snapshot") ) {
+			gpu_simulation.sync_to(entities);
+			if( !save_snapshot(entities, snapshot_path) ) {
+				TraceLog(LOG_WARNING, "SNAPSHOT: [%s] Failed to save snapshot", snapshot_path);
+			}
+		}
+		ImGui::SameLine();
+		if( ImGui::Button("Load Snapshot") ) {
+			if( load_snapshot(snapshot_path, entities) ) {
+				input.changes = 0;
+				reset_selection(input, entities);
+				change_selection(input, entities);
+			}
+			else {
+				TraceLog(LOG_WARNING, "SNAPSHOT: [%s] Failed to load snapshot", snapshot_path);
+			}
+		}
+	}
+
+	void handle_generator_ui(Input& input, EntityStore& entities, const World& world) {
+		auto& generator = input.generator;
+		if( !ImGui::CollapsingHeader("Scene Generator") ) {
+			return;
+		}
+		ImGui::InputInt("Count##Generator", &generator.count, 1000, 100000);
+		generator.count = std::max(generator.count, 0);
+		ImGui::SliderFloat("Circles##Generator", &generator.circle_fraction, 0.0f, 1.0f, "%.2f");
+		ImGui::DragFloatRange2("Size##Generator", &generator.min_extent, &generator.max_extent, 0.1f, 0.5f, 200.0f, "%.1f px");
+		ImGui::DragFloatRange2("Speed##Generator", &generator.min_speed, &generator.max_speed, 1.0f, 0.0f, 5000.0f, "%.0f px/s");
+		ImGui::ColorEdit3("Min Color##Generator", generator.min_color);
+		ImGui::ColorEdit3("Max Color##Generator", generator.max_color);
+		auto seed = static_cast<int>(generator.seed);
+		if( ImGui::InputInt("Seed##Generator", &seed) ) {
+			generator.seed = static_cast<std::uint32_t>(seed);
+		}
+		if( ImGui::Button("Generate") ) {
+			const auto start = std::chrono::steady_clock::now();
+			generate_entities(entities, generator, world, input.thread_count);
+			const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			TraceLog(LOG_INFO, "GENERATOR: Generated %d entities in %.1f ms", generator.count, elapsed);
+			input.changes = 0;
+			reset_selection(input, entities);
+			change_selection(input, entities);
+		}
+	}
+
+	void handle_spawn_ui(Input& input, const EntityStore& templates) {
+		if( !ImGui::CollapsingHeader("Spawner") || templates.size() == 0 ) {
+			return;
+		}
+		input.spawn_template = std::clamp(input.spawn_template, 0, static_cast<int>(templates.size()) - 1);
+		if( ImGui::BeginCombo("Template##Spawner", templates.name(static_cast<std::size_t>(input.spawn_template))) ) {
+			for( std::size_t t = 0; t < templates.size(); ++t ) {
+				// Templates whose lines were removed from the config are inactive
+				if( !templates.is_active[t] ) {
+					continue;
+				}
+				ImGui::PushID(static_cast<int>(t));
+				if( ImGui::Selectable(templates.name(t), static_cast<int>(t) == input.spawn_template) ) {
+					input.spawn_template = static_cast<int>(t);
+				}
+				ImGui::PopID();
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::InputInt("Count##Spawner", &input.spawn_count, 1, 100);
+		input.spawn_count = std::clamp(input.spawn_count, 1, 100000);
+		if( ImGui::Button("Spawn") ) {
+			input.spawn_requested = true;
+		}
+	}
+
+	void handle_recording_ui(const Input& input, SessionRecorder& recorder, EntityStore& entities, const World& world, GpuSimulation& gpu_simulation) {
+		constexpr auto session_path = "session.a1r";
+		if( !recorder.is_recording() ) {
+			if( ImGui::Button("Record Session") ) {
+				gpu_simulation.sync_to(entities);
+				recorder.begin(input, entities, world);
+			}
+			return;
+		}
+		const auto label = "Stop Recording (" + std::to_string(recorder.frame_count()) + " frames)";
+		if( ImGui::Button(label.c_str()) ) {
+			if( recorder.end(session_path) ) {
+				TraceLog(LOG_INFO, "SESSION: [%s] Saved %u frames", session_path, static_cast<unsigned>(recorder.frame_count()));
+			}
+			else {
+				TraceLog(LOG_WARNING, "SESSION: [%s] Failed to save session", session_path);
+			}
+		}
+	}
+
+	void handle_box_selection(Input& input, const EntityStore& entities) {
+		const auto mouse = GetScreenToWorld2D(GetMousePosition(), input.camera);
+		if( !input.is_box_selecting ) {
+			if( IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !ImGui::GetIO().WantCaptureMouse ) {
+				input.is_box_selecting = true;
+				input.box_start[0] = input.box_end[0] = mouse.x;
+				input.box_start[1] = input.box_end[1] = mouse.y;
+			}
+			return;
+		}
+		input.box_end[0] = mouse.x;
+		input.box_end[1] = mouse.y;
+		if( IsMouseButtonDown(MOUSE_BUTTON_LEFT) ) {
+			return;
+		}
+		input.is_box_selecting = false;
+
+		const auto left = std::min(input.box_start[0], input.box_end[0]);
+		const auto right = std::max(input.box_start[0], input.box_end[0]);
+		const auto top = std::min(input.box_start[1], input.box_end[1]);
+		const auto bottom = std::max(input.box_start[1], input.box_end[1]);
+		const auto is_click = (right - left) * input.camera.zoom < 3.0f && (bottom - top) * input.camera.zoom < 3.0f;
+		const auto extend = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+		auto& selection = input.selection;
+		if( !extend ) {
+			selection.clear();
+		}
+		// Rectangles draw over circles, and later entities over earlier ones
+		auto picked = std::size_t{ 0 };
+		auto picked_rank = std::size_t{ 0 };
+		for( const auto& range : entities.active_ranges ) {
+			for( auto i = range.begin; i < range.end; ++i ) {
+				const auto x = entities.render_x[i];
+				const auto y = entities.render_y[i];
+				if( is_click ) {
+					if( std::abs(mouse.x - x) <= entities.extent_x[i] * entities.scales[i] && std::abs(mouse.y - y) <= entities.extent_y[i] * entities.scales[i] ) {
+						const auto rank = static_cast<std::size_t>(entities.shape_types[i]) * entities.size() + i + 1;
+						if( rank > picked_rank ) {
+							picked = i;
+							picked_rank = rank;
+						}
+					}
+				}
+				else if( x >= left && x <= right && y >= top && y <= bottom ) {
+					selection.add(i);
+				}
+			}
+		}
+		if( picked_rank != 0 ) {
+			select_entity(input, entities.handle(picked), extend);
+			return;
+		}
+		if( !selection.contains(input.selected.index) && !selection.indices.empty() ) {
+			input.selected = entities.handle(selection.indices.front());
+		}
+		input.mark(InputChange::selection);
+	}
+
+	void handle_camera(Input& input) {
+		if( ImGui::GetIO().WantCaptureMouse ) {
+			return;
+		}
+		auto& camera = input.camera;
+		if( IsMouseButtonDown(MOUSE_BUTTON_RIGHT) || IsMouseButtonDown(MOUSE_BUTTON_MIDDLE) ) {
+			const auto delta = GetMouseDelta();
+			if( delta.x != 0.0f || delta.y != 0.0f ) {
+				camera.target.x -= delta.x / camera.zoom;
+				camera.target.y -= delta.y / camera.zoom;
+				input.mark(InputChange::view);
+			}
+		}
+		if( const auto wheel = GetMouseWheelMove(); wheel != 0.0f ) {
+			// Anchor the camera at the cursor so the point under it stays put
+			const auto mouse = GetMousePosition();
+			camera.target = GetScreenToWorld2D(mouse, camera);
+			camera.offset = mouse;
+			camera.zoom = std::clamp(camera.zoom * std::pow(1.125f, wheel), 0.03125f, 32.0f);
+			input.mark(InputChange::view);
+		}
+	}
+
+	void handle_config_reload(Input& input, ConfigWatcher& watcher, Config& config, EntityStore& entities, std::vector<char>& initial_state, GpuSimulation& gpu_simulation) {
+		A1_MEMORY_SCOPE(MemoryTag::config);
+		if( !watcher.poll() ) {
+			return;
+		}
+		// The reload marks a replaced scene, so the GPU buffers are rebuilt from the store
+		gpu_simulation.sync_to(entities);
+		const auto path = watcher.path().string();
+		const auto previous_font = config.font_asset.file;
+		auto changes = ConfigChanges{};
+		if( !reload_config(watcher.applied(), watcher.pending(), config, entities, changes) ) {
+			TraceLog(LOG_WARNING, "CONFIG: [%s] Failed to parse changes, keeping the current scene", path.c_str());
+			return;
+		}
+		watcher.accept();
+		write_snapshot(config.entity_templates, initial_state);
+		if( changes.window ) {
+			SetWindowTitle(config.window.caption.c_str());
+			SetWindowSize(config.window.width, config.window.height);
+		}
+		if( changes.font ) {
+			if( config.font_asset.file != previous_font ) {
+				TraceLog(LOG_WARNING, "CONFIG: [%s] Font file changes take effect after a restart", path.c_str());
+			}
+			input.text_size = config.font_asset.size;
+			input.text_color[0] = config.font_asset.color.r;
+			input.text_color[1] = config.font_asset.color.g;
+			input.text_color[2] = config.font_asset.color.b;
+		}
+		// Refresh the selected entity's fields, and anything copied from the store
+		input.filter_dirty = true;
+		input.mark(InputChange::selection);
+		input.mark(InputChange::view);
+		input.mark(InputChange::scene);
+		TraceLog(LOG_INFO, "CONFIG: [%s] Reloaded: %zu added, %zu changed, %zu removed", path.c_str(), changes.added, changes.changed, changes.removed);
+	}
+
+	void handle_selected_shape_ui(Input& input, EntityStore& entities) {
+		ImGui::SeparatorText("Selected Shape Controls");
+		if( entities.size() == 0 ) {
+			return;
+		}
+		if( ImGui::InputTextWithHint("Filter", "name, or * and ? wildcards", &input.filter) ) {
+			input.filter_dirty = true;
+		}
+		if( ImGui::Combo("Type", &input.filter_shape, "Any\0Circle\0Rectangle\0") ) {
+			input.filter_dirty = true;
+		}
+		if( input.filter_dirty ) {
+			filter_entities(input, entities);
+		}
+
+		auto& selection = input.selection;
+		if( ImGui::BeginChild("Entities", ImVec2(0, 160), true) ) {
+			const auto& io = ImGui::GetIO();
+			auto clipper = ImGuiListClipper{};
+			clipper.Begin(static_cast<int>(input.filtered.size()));
+			while( clipper.Step() ) {
+				for( auto row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row ) {
+					const auto i = input.filtered[row];
+					ImGui::PushID(static_cast<int>(i));
+					if( ImGui::Selectable(entities.name(i), selection.contains(i)) ) {
+						if( io.KeyShift ) {
+							// Range from the primary entity's row, or just this row if it is filtered out
+							const auto anchor = std::find(input.filtered.begin(), input.filtered.end(), input.selected.index);
+							const auto anchor_row = anchor == input.filtered.end() ? row : static_cast<int>(anchor - input.filtered.begin());
+							if( !io.KeyCtrl ) {
+								selection.clear();
+							}
+							for( auto range_row = std::min(row, anchor_row); range_row <= std::max(row, anchor_row); ++range_row ) {
+								selection.add(input.filtered[range_row]);
+							}
+							input.mark(InputChange::selection);
+						}
+						else if( io.KeyCtrl && selection.contains(i) ) {
+							selection.remove(i);
+							if( input.selected.index == i && !selection.indices.empty() ) {
+								input.selected = entities.handle(selection.indices.back());
+							}
+							input.mark(InputChange::selection);
+						}
+						else {
+							select_entity(input, entities.handle(i), io.KeyCtrl);
+						}
+					}
+					ImGui::PopID();
+				}
+			}
+		}
+		ImGui::EndChild();
+		if( ImGui::Button("Select Listed") && !input.filtered.empty() ) {
+			selection.clear();
+			for( const auto i : input.filtered ) {
+				selection.add(i);
+			}
+			input.selected = entities.handle(input.filtered.front());
+			input.mark(InputChange::selection);
+		}
+		ImGui::SameLine();
+		if( ImGui::Button("Clear Selection") ) {
+			selection.clear();
+			input.mark(InputChange::selection);
+		}
+		ImGui::SameLine();
+		ImGui::BeginDisabled(selection.indices.empty());
+		if( ImGui::Button("Delete") ) {
+			input.despawn_requested = true;
+		}
+		ImGui::EndDisabled();
+		ImGui::SameLine();
+		ImGui::Text("%zu selected", selection.indices.size());
+
+		ImGui::BeginDisabled(selection.indices.empty());
+		if( ImGui::Checkbox("Active", &input.is_active) ) {
+			input.mark(InputChange::is_active);
+		}
+		if( ImGui::SliderFloat("Scale", &input.scale, 0.1f, 5.0f) ) {
+			input.mark(InputChange::scale);
+		}
+		// Track the components separately so dragging one keeps the other live
+		const float velocity[2] ={ input.velocity[0], input.velocity[1] };
+		if( ImGui::SliderFloat2("Velocity", input.velocity, -75.0f * reference_tick_rate, 75.0f * reference_tick_rate, "%.0f") ) {
+			if( input.velocity[0] != velocity[0] ) {
+				input.mark(InputChange::velocity_x);
+			}
+			if( input.velocity[1] != velocity[1] ) {
+				input.mark(InputChange::velocity_y);
+			}
+		}
+		if( ImGui::ColorEdit3("Color", input.color) ) {
+			input.mark(InputChange::color);
+		}
+		if( ImGui::InputText("Name", &input.name) ) {
+			input.mark(InputChange::name);
+		}
+		ImGui::EndDisabled();
+	}
+
+	void handle_simulation(const Input& input, const World& world, EntityStore& entities, SimulationClock& clock, CollisionGrid& collision_grid, float frame_time) {
+		if( !input.simulate_enabled ) {
+			clock ={};
+			interpolate_positions(entities, clock.alpha);
+			return;
+		}
+		if( !clock.is_running ) {
+			// Previous positions are stale after a pause
+			entities.previous_x = entities.position_x;
+			entities.previous_y = entities.position_y;
+			clock.is_running = true;
+		}
+		const auto step = 1.0 / std::max(input.tick_rate, 1.0f);
+		const auto steps = clock.advance(step, input.max_catch_up_steps, frame_time);
+		for( int tick = 0; tick < steps; ++tick ) {
+			entities.previous_x = entities.position_x;
+			entities.previous_y = entities.position_y;
+			if( input.parallel_enabled ) {
+				move_parallel(entities, world, static_cast<float>(step), input.motion, input.thread_count, static_cast<std::size_t>(input.min_chunk_size));
+			}
+			else {
+				move(entities, world, static_cast<float>(step), input.motion);
+			}
+			if( input.collide_enabled ) {
+				collision_grid.resolve(entities, world);
+			}
+		}
+		interpolate_positions(entities, clock.alpha);
+	}
+
+	void handle_spawning(Input& input, const EntityStore& templates, EntityStore& entities, GpuSimulation& gpu_simulation) {
+		if( !input.spawn_requested && !input.despawn_requested ) {
+			return;
+		}
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		auto& selection = input.selection;
+		auto& slots = input.spawn_slots;
+		slots.clear();
+		if( input.despawn_requested ) {
+			for( const auto i : selection.indices ) {
+				if( entities.despawn(entities.handle(i)) ) {
+					slots.push_back(i);
+				}
+			}
+			selection.clear();
+		}
+		const auto first_spawned = slots.size();
+		if( input.spawn_requested && static_cast<std::size_t>(input.spawn_template) < templates.size() ) {
+			const auto t = static_cast<std::size_t>(input.spawn_template);
+			const auto name = templates.name_table.view(templates.names[t]);
+			const auto position = Position{ templates.position_x[t], templates.position_y[t] };
+			const auto shape = templates.shape(t);
+			const auto count = static_cast<std::size_t>(input.spawn_count);
+			// Spawns past the free slots grow the store, which the GPU buffers
+			// are then rebuilt from, so the GPU's positions are read back first
+			if( count > entities.free_slots[static_cast<std::size_t>(templates.shape_types[t])].size() ) {
+				gpu_simulation.stop(entities);
+			}
+			for( std::size_t k = 0; k < count; ++k ) {
+				const auto angle = 2 * std::numbers::pi_v<float> * static_cast<float>(k) / static_cast<float>(count);
+				const auto velocity = Velocity{
+					templates.velocity_x[t] * std::cos(angle) - templates.velocity_y[t] * std::sin(angle),
+					templates.velocity_x[t] * std::sin(angle) + templates.velocity_y[t] * std::cos(angle)
+				};
+				slots.push_back(entities.spawn(name, position, velocity, shape, templates.scales[t], templates.colors[t], true).index);
+			}
+		}
+		entities.update_active_set(slots);
+		selection.resize(entities.size());
+		if( slots.size() > first_spawned ) {
+			selection.clear();
+			for( auto k = first_spawned; k < slots.size(); ++k ) {
+				selection.add(slots[k]);
+			}
+			input.selected = entities.handle(slots[first_spawned]);
+			input.mark(InputChange::selection);
+		}
+		input.spawn_requested = false;
+		input.despawn_requested = false;
+		input.filter_dirty = true;
+		input.mark(InputChange::view);
+		input.mark(InputChange::spawn);
+	}
+
+	bool handle_scene_loading(Input& input, SceneLoader& loader, Config& config, EntityStore& entities, std::vector<char>& initial_state, ConfigWatcher& watcher) {
+		A1_MEMORY_SCOPE(MemoryTag::config);
+		if( loader.poll(config.entity_templates, entities) > 0 ) {
+			input.filter_dirty = true;
+			input.mark(InputChange::view);
+			input.mark(InputChange::scene);
+		}
+		if( const auto* error = loader.error() ) {
+			throw std::runtime_error(error);
+		}
+		if( loader.is_loading() ) {
+			return true;
+		}
+		write_snapshot(config.entity_templates, initial_state);
+		watcher = loader.take_watcher();
+		TraceLog(LOG_INFO, "LOADER: Loaded %zu entities", entities.size());
+		return false;
+	}
+
+	void handle_loading_ui(const SceneLoader& loader, const EntityStore& entities) {
+		ImGui::SeparatorText("Loading Scene");
+		ImGui::ProgressBar(loader.progress());
+		ImGui::Text("%zu entities loaded", entities.size());
+	}
+
+	void handle_text_ui(Input& input) {
+		ImGui::SeparatorText("Text Controls");
+		if( ImGui::SliderFloat("Size##Text", &input.text_size, 8.0f, 72.0f) ) {
+			input.mark(InputChange::view);
+		}
+		if( ImGui::ColorEdit3("Color##Text", input.text_color) ) {
+			input.mark(InputChange::view);
+		}
+		if( ImGui::SliderFloat("Min Size##Text", &input.lod.min_text_size, 0.0f, 24.0f, "%.1f px") ) {
+			input.mark(InputChange::view);
+		}
+	}
+
+	void filter_entities(Input& input, const EntityStore& entities) {
+		input.filtered.clear();
+		for( std::size_t i = 0; i < entities.size(); ++i ) {
+			if( !entities.is_alive(i) ) {
+				continue;
+			}
+			if( input.filter_shape != 0 && static_cast<int>(entities.shape_types[i]) + 1 != input.filter_shape ) {
+				continue;
+			}
+			if( matches_name(entities.name_table.view(entities.names[i]), input.filter) ) {
+				input.filtered.push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+		input.filter_dirty = false;
+	}
+
+	void interpolate_positions(EntityStore& entities, float alpha) {
+		const auto count = entities.size();
+		for( std::size_t i = 0; i < count; ++i ) {
+			entities.render_x[i] = entities.previous_x[i] + (entities.position_x[i] - entities.previous_x[i]) * alpha;
+			entities.render_y[i] = entities.previous_y[i] + (entities.position_y[i] - entities.previous_y[i]) * alpha;
+		}
+	}
+
+	void initialize_ui(Input& input, const EntityStore& entities, const FontAsset& font_asset) {
+		reset_selection(input, entities);
+		change_selection(input, entities);
+		input.text_size = font_asset.size;
+		input.text_color[0] = font_asset.color.r;
+		input.text_color[1] = font_asset.color.g;
+		input.text_color[2] = font_asset.color.b;
+	}
+
+	bool are_nametags_shown(const Input& input) {
+		return input.draw_text_enabled && input.text_size * input.camera.zoom >= input.lod.min_text_size;
+	}
+
+	bool intersects(const AABB& a, const AABB& b) {
+		return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+	}
+
+	bool is_fragmented(const std::vector<IndexRange>& ranges, std::size_t count, std::size_t lanes) {
+		return ranges.size() * lanes > count;
+	}
+
+	Config load_config(const std::filesystem::path& path) {
+		A1_MEMORY_SCOPE(MemoryTag::config);
+		const auto file = MappedFile{ path };
+		a1::Config config;
+		if( !file.is_open() || !parse_config(file.text(), config) ) {
+			throw std::runtime_error("Failed to read configuration file.");
+		}
+		return config;
+	}
+
+	bool load_snapshot(const std::filesystem::path& path, EntityStore& entities) {
+		const auto file = MappedFile{ path };
+		return file.is_open() && restore_snapshot(file.text(), entities);
+	}
+
+	void integrate_active(const IntegrationBatch& batch, void (*integrate)(const IntegrationBatch& batch), const std::vector<IndexRange>& ranges) {
+		const auto first = std::partition_point(ranges.begin(), ranges.end(), [&](const IndexRange& range) { return range.end <= batch.begin; });
+		auto run = batch;
+		for( auto range = first; range != ranges.end() && range->begin < batch.end; ++range ) {
+			run.begin = std::max<std::size_t>(range->begin, batch.begin);
+			run.end = std::min<std::size_t>(range->end, batch.end);
+			integrate(run);
+		}
+	}
+
+	template<std::uint32_t Features>
+	void integrate_scalar(const IntegrationBatch& batch) {
+		constexpr auto wrap = (Features & static_cast<std::uint32_t>(MotionFeature::wrap)) != 0;
+		constexpr auto gravity = (Features & static_cast<std::uint32_t>(MotionFeature::gravity)) != 0;
+		constexpr auto damping = (Features & static_cast<std::uint32_t>(MotionFeature::damping)) != 0;
+		for( auto i = batch.begin; i < batch.end; ++i ) {
+			if( !batch.is_active[i] ) {
+				continue;
+			}
+			if constexpr( damping ) {
+				batch.velocity_x[i] *= batch.damping;
+				batch.velocity_y[i] *= batch.damping;
+			}
+			if constexpr( gravity ) {
+				batch.velocity_y[i] += batch.gravity;
+			}
+			if constexpr( wrap ) {
+				// Shapes wrap once their centre leaves the world
+				auto x = batch.position_x[i] + batch.velocity_x[i] * batch.dt;
+				auto y = batch.position_y[i] + batch.velocity_y[i] * batch.dt;
+				if( x < 0 ) {
+					x += batch.width;
+				}
+				else if( x > batch.width ) {
+					x -= batch.width;
+				}
+				if( y < 0 ) {
+					y += batch.height;
+				}
+				else if( y > batch.height ) {
+					y -= batch.height;
+				}
+				batch.position_x[i] = x;
+				batch.position_y[i] = y;
+			}
+			else {
+				// Every shape is bounded by its scaled half-extents, so the bounds test
+				// needs no per-type dispatch
+				const auto next_x = batch.position_x[i] + batch.velocity_x[i] * batch.dt;
+				const auto next_y = batch.position_y[i] + batch.velocity_y[i] * batch.dt;
+				const auto half_width = batch.extent_x[i] * batch.scales[i];
+				const auto half_height = batch.extent_y[i] * batch.scales[i];
+				// If the shape goes outside the screen, adjust velocity in the appropriate
+				// direction
+				if( next_x - half_width < 0 || next_x + half_width > batch.width ) {
+					batch.velocity_x[i] = -batch.velocity_x[i];
+				}
+				if( next_y - half_height < 0 || next_y + half_height > batch.height ) {
+					batch.velocity_y[i] = -batch.velocity_y[i];
+				}
+				batch.position_x[i] += batch.velocity_x[i] * batch.dt;
+				batch.position_y[i] += batch.velocity_y[i] * batch.dt;
+			}
+		}
+	}
+
+#if defined(__GNUC__)
+	namespace {
+		/**
+		 * GCC/Clang vector extension types with the specified number of lanes.
+		 */
+		template<std::size_t Lanes>
+		struct SimdLanes {
+			typedef float Float __attribute__((vector_size(Lanes * sizeof(float))));
+			typedef std::int32_t Mask __attribute__((vector_size(Lanes * sizeof(float))));
+			typedef std::uint8_t Bytes __attribute__((vector_size(Lanes)));
+		};
+
+		/**
+		 * Integrates a batch of entities Lanes at a time.
+		 * @details Generic over vector width; each instruction set entry point below
+		 *          inlines it so the vector operations are lowered for that target.
+		 *          Bounces are applied by XOR-ing the sign bit with the out-of-bounds
+		 *          mask, and inactive lanes are masked out of the position update.
+		 *          Comparisons are avoided because GCC splits wide vector compares
+		 *          into scalar code on some targets.
+		 * @tparam Lanes Vector width
+		 * @tparam Features MotionFeature flags
+		 * @param batch Entity range to integrate
+		 */
+		template<std::size_t Lanes, std::uint32_t Features>
+		inline void integrate_lanes(const IntegrationBatch& batch) {
+			constexpr auto wrap = (Features & static_cast<std::uint32_t>(MotionFeature::wrap)) != 0;
+			constexpr auto gravity = (Features & static_cast<std::uint32_t>(MotionFeature::gravity)) != 0;
+			constexpr auto damping = (Features & static_cast<std::uint32_t>(MotionFeature::damping)) != 0;
+			using Float = typename SimdLanes<Lanes>::Float;
+			using Mask = typename SimdLanes<Lanes>::Mask;
+			using Bytes = typename SimdLanes<Lanes>::Bytes;
+			const auto sign = Mask{} + std::numeric_limits<std::int32_t>::min();
+			auto i = batch.begin;
+			for( ; i + Lanes <= batch.end; i += Lanes ) {
+				Float position_x, position_y, velocity_x, velocity_y, extent_x, extent_y, scale;
+				Bytes is_active;
+				std::memcpy(&position_x, batch.position_x + i, sizeof(Float));
+				std::memcpy(&position_y, batch.position_y + i, sizeof(Float));
+				std::memcpy(&velocity_x, batch.velocity_x + i, sizeof(Float));
+				std::memcpy(&velocity_y, batch.velocity_y + i, sizeof(Float));
+				std::memcpy(&extent_x, batch.extent_x + i, sizeof(Float));
+				std::memcpy(&extent_y, batch.extent_y + i, sizeof(Float));
+				std::memcpy(&scale, batch.scales + i, sizeof(Float));
+				std::memcpy(&is_active, batch.is_active + i, sizeof(Bytes));
+				// Active flags are stored as 0 or 1, so negating gives an all-ones lane mask
+				const Mask active = -__builtin_convertvector(is_active, Mask);
+
+				// Forces only change active lanes, selected by masking the new velocity
+				// in and the old one out
+				if constexpr( damping ) {
+					velocity_x = (Float)(((Mask)(velocity_x * batch.damping) & active) | ((Mask)velocity_x & ~active));
+					velocity_y = (Float)(((Mask)(velocity_y * batch.damping) & active) | ((Mask)velocity_y & ~active));
+				}
+				if constexpr( gravity ) {
+					velocity_y += (Float)((Mask)(Float{} + batch.gravity) & active);
+				}
+				if constexpr( wrap ) {
+					// Shifting the sign bit across the lane gives an all-ones mask for a
+					// centre left of or above the world, and for one right of or below it,
+					// selecting the world size to add or subtract
+					position_x += (Float)((Mask)velocity_x & active) * batch.dt;
+					position_y += (Float)((Mask)velocity_y & active) * batch.dt;
+					const auto width = Float{} + batch.width;
+					const auto height = Float{} + batch.height;
+					const Mask below_x = ((Mask)position_x >> 31) & active;
+					const Mask above_x = ((Mask)(width - position_x) >> 31) & active;
+					const Mask below_y = ((Mask)position_y >> 31) & active;
+					const Mask above_y = ((Mask)(height - position_y) >> 31) & active;
+					position_x += (Float)((Mask)width & below_x) - (Float)((Mask)width & above_x);
+					position_y += (Float)((Mask)height & below_y) - (Float)((Mask)height & above_y);
+				}
+				else {
+					// The sign bits of (left edge - 0) and (width - right edge) are set
+					// exactly when the shape is outside the world, so OR-ing them gives the
+					// bounce mask without vector comparisons
+					const auto next_x = position_x + velocity_x * batch.dt;
+					const auto next_y = position_y + velocity_y * batch.dt;
+					const auto half_width = extent_x * scale;
+					const auto half_height = extent_y * scale;
+					const Mask out_x = (Mask)(next_x - half_width) | (Mask)(batch.width - (next_x + half_width));
+					const Mask out_y = (Mask)(next_y - half_height) | (Mask)(batch.height - (next_y + half_height));
+					velocity_x = (Float)((Mask)velocity_x ^ (out_x & active & sign));
+					velocity_y = (Float)((Mask)velocity_y ^ (out_y & active & sign));
+					position_x += (Float)((Mask)velocity_x & active) * batch.dt;
+					position_y += (Float)((Mask)velocity_y & active) * batch.dt;
+				}
+
+				std::memcpy(batch.position_x + i, &position_x, sizeof(Float));
+				std::memcpy(batch.position_y + i, &position_y, sizeof(Float));
+				std::memcpy(batch.velocity_x + i, &velocity_x, sizeof(Float));
+				std::memcpy(batch.velocity_y + i, &velocity_y, sizeof(Float));
+			}
+			auto remainder = batch;
+			remainder.begin = i;
+			integrate_scalar<Features>(remainder);
+		}
+
+#if defined(__x86_64__) || defined(__i386__)
+		struct Sse2Kernel {
+			template<std::uint32_t Features>
+			__attribute__((target("sse2"), flatten))
+			static void integrate(const IntegrationBatch& batch) {
+				integrate_lanes<4, Features>(batch);
+			}
+		};
+
+		struct Avx2Kernel {
+			template<std::uint32_t Features>
+			__attribute__((target("avx2"), flatten))
+			static void integrate(const IntegrationBatch& batch) {
+				integrate_lanes<8, Features>(batch);
+			}
+		};
+
+		struct Avx512Kernel {
+			template<std::uint32_t Features>
+			__attribute__((target("avx512f,avx512dq,avx512bw,avx512vl"), flatten))
+			static void integrate(const IntegrationBatch& batch) {
+				integrate_lanes<16, Features>(batch);
+			}
+		};
+#elif defined(__ARM_NEON)
+		struct NeonKernel {
+			template<std::uint32_t Features>
+			__attribute__((flatten))
+			static void integrate(const IntegrationBatch& batch) {
+				integrate_lanes<4, Features>(batch);
+			}
+		};
+#endif
+	}
+#endif
+
+	namespace {
+		struct ScalarKernel {
+			template<std::uint32_t Features>
+			static void integrate(const IntegrationBatch& batch) {
+				integrate_scalar<Features>(batch);
+			}
+		};
+
+		/**
+		 * Instantiates a kernel for every MotionFeature combination.
+		 * @tparam Kernel Type with a static integrate member template over the feature flags
+		 * @return Kernel variants indexed by feature flags
+		 */
+		template<typename Kernel, std::size_t... Features>
+		constexpr IntegrationVariants make_integration_variants(std::index_sequence<Features...>) {
+			return { &Kernel::template integrate<static_cast<std::uint32_t>(Features)>... };
+		}
+
+		template<typename Kernel>
+		constexpr IntegrationVariants make_integration_variants() {
+			return make_integration_variants<Kernel>(std::make_index_sequence<motion_variant_count>{});
+		}
+	}
+
+	IntegrationBatch make_integration_batch(EntityStore& entities, const World& world, float dt, const MotionSettings& motion) {
+		return {
+			entities.position_x.data(),
+			entities.position_y.data(),
+			entities.velocity_x.data(),
+			entities.velocity_y.data(),
+			entities.extent_x.data(),
+			entities.extent_y.data(),
+			entities.scales.data(),
+			entities.is_active.data(),
+			0,
+			entities.size(),
+			static_cast<float>(world.width),
+			static_cast<float>(world.height),
+			dt,
+			motion.gravity * dt,
+			std::exp(-motion.damping * dt)
+		};
+	}
+
+	void move(EntityStore& entities, const World& world, float dt, const MotionSettings& motion) {
+		static const auto kernel = select_integration_kernel();
+		const auto integrate = kernel.integrate[motion.features()];
+		const auto batch = make_integration_batch(entities, world, dt, motion);
+		if( is_fragmented(entities.active_ranges, entities.size(), kernel.lanes) ) {
+			integrate(batch);
+		}
+		else {
+			integrate_active(batch, integrate, entities.active_ranges);
+		}
+	}
+
+	void move_parallel(EntityStore& entities, const World& world, float dt, const MotionSettings& motion, int thread_count, std::size_t min_chunk_size) {
+#if defined(_OPENMP)
+		static const auto kernel = select_integration_kernel();
+		const auto max_threads = static_cast<std::size_t>(thread_count > 0 ? thread_count : omp_get_max_threads());
+		const auto chunk_count = std::min(max_threads, entities.size() / std::max<std::size_t>(min_chunk_size, 1));
+		if( chunk_count <= 1 ) {
+			move(entities, world, dt, motion);
+			return;
+		}
+		// Chunk sizes are rounded up to 16 entities, a multiple of every kernel's
+		// lane count, so each chunk but the last fills whole vectors
+		constexpr std::size_t alignment = 16;
+		const auto batch = make_integration_batch(entities, world, dt, motion);
+		const auto integrate = kernel.integrate[motion.features()];
+		const auto sweep_all = is_fragmented(entities.active_ranges, entities.size(), kernel.lanes);
+		const auto chunk_size = ((entities.size() + chunk_count - 1) / chunk_count + alignment - 1) / alignment * alignment;
+		const auto chunks = static_cast<long long>(chunk_count);
+		#pragma omp parallel for num_threads(static_cast<int>(chunk_count)) schedule(static)
+		for( long long chunk = 0; chunk < chunks; ++chunk ) {
+			auto chunk_batch = batch;
+			chunk_batch.begin = std::min(static_cast<std::size_t>(chunk) * chunk_size, batch.end);
+			chunk_batch.end = std::min(chunk_batch.begin + chunk_size, batch.end);
+			if( sweep_all ) {
+				integrate(chunk_batch);
+			}
+			else {
+				integrate_active(chunk_batch, integrate, entities.active_ranges);
+			}
+		}
+#else
+		move(entities, world, dt, motion);
+#endif
+	}
+
+	void measure_names(EntityStore& entities, const Font& font, float text_size) {
+		const auto measure = [&](NameId id) {
+			const auto extent = MeasureTextEx(font, entities.name_table.c_str(id), text_size, 1.0f);
+			entities.name_width[id] = extent.x;
+			entities.name_height[id] = extent.y;
+		};
+		if( entities.name_text_size != text_size ) {
+			for( NameId id = 0; id < entities.name_table.size(); ++id ) {
+				measure(id);
+			}
+			entities.name_text_size = text_size;
+		}
+		else {
+			for( const auto id : entities.stale_names ) {
+				measure(id);
+			}
+		}
+		entities.stale_names.clear();
+	}
+
+	MemoryUsage memory_usage(MemoryTag tag) {
+		const auto& counters = memory_counters[static_cast<std::size_t>(tag)];
+		return {
+			counters.live_bytes.load(std::memory_order_relaxed),
+			counters.peak_bytes.load(std::memory_order_relaxed),
+			counters.allocations.load(std::memory_order_relaxed)
+		};
+	}
+
+	bool parse_benchmark_options(int argc, char* argv[], BenchmarkOptions& options) {
+		for( int i = 1; i < argc; ++i ) {
+			const auto argument = std::string_view{ argv[i] };
+			const auto has_value = i + 1 < argc;
+			try {
+				if( argument == "--entities" && has_value ) {
+					options.entity_counts.clear();
+					const auto list = std::string_view{ argv[++i] };
+					for( std::size_t begin = 0, end = 0; begin < list.size(); begin = end + 1 ) {
+						end = std::min(list.find(',', begin), list.size());
+						// Scenes are generated with an int count
+						auto count = std::size_t{ 0 };
+						if( !parse_argument(list.substr(begin, end - begin), count) || count > static_cast<std::size_t>(std::numeric_limits<int>::max()) ) {
+							return false;
+						}
+						options.entity_counts.push_back(count);
+					}
+				}
+				else if( argument == "--config" && has_value ) {
+					options.config_path = argv[++i];
+				}
+				else if( argument == "--replay" && has_value ) {
+					options.replay_path = argv[++i];
+				}
+				else if( argument == "--frames" && has_value ) {
+					if( !parse_argument(argv[++i], options.frames) ) {
+						return false;
+					}
+					options.frames = std::max<std::size_t>(options.frames, 1);
+				}
+				else if( argument == "--warmup" && has_value ) {
+					if( !parse_argument(argv[++i], options.warmup_frames) ) {
+						return false;
+					}
+				}
+				else if( argument == "--render" ) {
+					options.render = true;
+				}
+				else if( argument == "--parallel" ) {
+					options.parallel = true;
+				}
+				else if( argument == "--collide" ) {
+					options.collide = true;
+				}
+				else if( argument == "--wrap" ) {
+					options.motion.wrap = true;
+				}
+				else if( argument == "--gravity" && has_value ) {
+					options.motion.gravity = std::stof(argv[++i]);
+				}
+				else if( argument == "--damping" && has_value ) {
+					options.motion.damping = std::stof(argv[++i]);
+				}
+				else if( argument == "--threads" && has_value ) {
+					if( !parse_argument(argv[++i], options.thread_count) ) {
+						return false;
+					}
+				}
+				else if( argument == "--seed" && has_value ) {
+					if( !parse_argument(argv[++i], options.seed) ) {
+						return false;
+					}
+				}
+				else if( argument == "--json" ) {
+					options.json = true;
+				}
+				else {
+					return false;
+				}
+			}
+			catch( const std::logic_error& ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	bool parse_argument(std::string_view text, T& value) {
+		const auto* end = text.data() + text.size();
+		auto parsed = T{};
+		const auto [last, error] = std::from_chars(text.data(), end, parsed);
+		if( error != std::errc{} || last != end ) {
+			return false;
+		}
+		value = parsed;
+		return true;
+	}
 
-		// Draw
-		//----------------------------------------------------------------------------------
-		BeginDrawing();
+	std::uint32_t pack_color(Color color) {
+		// Same rounding as raylib's ColorFromNormalized
+		const auto channel = [](float value) {
+			return static_cast<std::uint32_t>(static_cast<unsigned char>(value * 255.0f));
+		};
+		return channel(color.r) | channel(color.g) << 8 | channel(color.b) << 16 | channel(color.a) << 24;
+	}
 
-		ClearBackground(BLACK);
+	namespace {
+		/**
+		 * Reads whitespace-separated values from config text in place.
+		 * @details Numbers are read from the cursor up to the first character that
+		 *          cannot continue them, as formatted stream extraction does.
+		 */
+		struct ConfigCursor {
+			const char* next;
+			const char* end;
+			// Set when a read failed because the text ran out
+			bool exhausted = false;
 
-		//********** Raylib Drawing Content **********
-		handle_rendering(input, font, font_asset, entities);
+			void skip_space() {
+				while( next != end && (*next == ' ' || (*next >= '\t' && *next <= '\r')) ) {
+					++next;
+				}
+			}
 
-		//********** ImGUI Content *********
-		rlImGuiBegin();
-		ImGui::SetNextWindowSize(ImVec2(400, 520));
-		ImGui::Begin("Assignment 1 Controls", NULL, ImGuiWindowFlags_NoResize|ImGuiWindowFlags_NoCollapse);
-		handle_all_shape_controls_ui(input);
-		handle_selected_shape_ui(input, entities);
-		handle_text_ui(input);
-		handle_reset_ui(input, entity_templates, entities, font_asset);
-		ImGui::End();
-		rlImGuiEnd();
+			bool read(std::string_view& token) {
+				skip_space();
+				if( next == end ) {
+					exhausted = true;
+					return false;
+				}
+				const auto* first = next;
+				while( next != end && !(*next == ' ' || (*next >= '\t' && *next <= '\r')) ) {
+					++next;
+				}
+				token = { first, static_cast<std::size_t>(next - first) };
+				return true;
+			}
 
-		EndDrawing();
-		//----------------------------------------------------------------------------------
-	}
+			// Paths may be quoted with backslash escapes, as std::quoted reads them
+			bool read(std::filesystem::path& path) {
+				skip_space();
+				if( next == end || *next != '"' ) {
+					auto token = std::string_view{};
+					if( !read(token) ) {
+						return false;
+					}
+					path = token;
+					return true;
+				}
+				auto unquoted = std::string{};
+				for( ++next; next != end && *next != '"'; ++next ) {
+					if( *next == '\\' && next + 1 != end ) {
+						++next;
+					}
+					unquoted.push_back(*next);
+				}
+				if( next == end ) {
+					exhausted = true;
+					return false;
+				}
+				++next;
+				path = std::move(unquoted);
+				return true;
+			}
 
-	// Clean Up
-	//--------------------------------------------------------------------------------------
-	rlImGuiShutdown();    // Shuts down the raylib ImGui backend
-	UnloadFont(font);     // Remove font from memory
-	CloseWindow();        // Close window and OpenGL context
-	//--------------------------------------------------------------------------------------
+			template<typename T>
+			bool read(T& value) {
+				skip_space();
+				if( next == end ) {
+					exhausted = true;
+					return false;
+				}
+				// from_chars rejects the leading plus sign streams accept
+				const auto* first = next;
+				if( *first == '+' && first + 1 != end && first[1] != '-' ) {
+					++first;
+				}
+				const auto [last, error] = std::from_chars(first, end, value);
+				if( error != std::errc{} ) {
+					return false;
+				}
+				next = last;
+				return true;
+			}
 
-	return 0;
-}
+			// Short plain decimals take a fast path: their digits and power of ten
+			// are exact floats, so one division rounds as from_chars does
+			bool read(float& value) {
+				static constexpr float powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f };
+				skip_space();
+				const auto* cursor = next;
+				const auto negative = cursor != end && *cursor == '-';
+				if( cursor != end && (*cursor == '-' || *cursor == '+') ) {
+					++cursor;
+				}
+				std::uint32_t mantissa = 0;
+				int digits = 0;
+				int fraction_digits = 0;
+				for( ; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor, ++digits ) {
+					mantissa = mantissa * 10 + static_cast<std::uint32_t>(*cursor - '0');
+				}
+				if( cursor != end && *cursor == '.' ) {
+					for( ++cursor; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor, ++digits, ++fraction_digits ) {
+						mantissa = mantissa * 10 + static_cast<std::uint32_t>(*cursor - '0');
+					}
+				}
+				if( digits > 0 && digits <= 7 && (cursor == end || (*cursor != 'e' && *cursor != 'E')) ) {
+					value = static_cast<float>(mantissa) / powers_of_ten[fraction_digits];
+					value = negative ? -value : value;
+					next = cursor;
+					return true;
+				}
+				return read<float>(value);
+			}
 
-namespace a1 {
-	AABB Circle::aabb(Position position, float scale) const {
-		return {
-			position.x - radius * scale,
-			position.y - radius * scale,
-			2 * radius * scale,
-			2 * radius * scale
+			template<typename... T>
+			bool read_all(T&... values) {
+				return (read(values) && ...);
+			}
 		};
-	}
 
-	void Circle::draw(Position position, float scale, Color color) const {
-		DrawCircle(
-			static_cast<int>(position.x),
-			static_cast<int>(position.y),
-			radius * scale,
-			ColorFromNormalized({ color.r, color.g, color.b, color.a })
-		);
+		/**
+		 * Reads an entity's common components (i.e. not the shape) and the shape's values.
+		 */
+		template<typename... T>
+		bool read_entity(ConfigCursor& cursor, std::string_view& name, Position& position, Velocity& velocity, Color& color, T&... shape_values) {
+			if( !cursor.read_all(name, position.x, position.y, velocity.x, velocity.y, color.r, color.g, color.b, shape_values...) ) {
+				return false;
+			}
+			velocity.x *= reference_tick_rate;
+			velocity.y *= reference_tick_rate;
+			color.a = 1.0f;
+			return true;
+		}
 	}
 
-	AABB Rectangle::aabb(Position position, float scale) const {
-		return {
-			position.x - width * scale / 2,
-			position.y - height * scale / 2,
-			width * scale,
-			height * scale
+	bool matches_name(std::string_view name, std::string_view pattern) {
+		const auto equal = [](char a, char b) {
+			return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
 		};
+		if( pattern.find_first_of("*?") == std::string_view::npos ) {
+			return std::search(name.begin(), name.end(), pattern.begin(), pattern.end(), equal) != name.end() || pattern.empty();
+		}
+		// Greedy wildcard matching that backtracks to the most recent star
+		std::size_t n = 0, p = 0;
+		auto star = std::string_view::npos;
+		auto resume = std::size_t{ 0 };
+		while( n < name.size() ) {
+			if( p < pattern.size() && (pattern[p] == '?' || (pattern[p] != '*' && equal(pattern[p], name[n]))) ) {
+				++n;
+				++p;
+			}
+			else if( p < pattern.size() && pattern[p] == '*' ) {
+				star = p++;
+				resume = n;
+			}
+			else if( star != std::string_view::npos ) {
+				p = star + 1;
+				n = ++resume;
+			}
+			else {
+				return false;
+			}
+		}
+		while( p < pattern.size() && pattern[p] == '*' ) {
+			++p;
+		}
+		return p == pattern.size();
 	}
 
-	void Rectangle::draw(Position position, float scale, Color color) const {
-		DrawRectangle(
-			static_cast<int>(position.x - width * scale / 2),
-			static_cast<int>(position.y - height * scale / 2),
-			static_cast<int>(width * scale),
-			static_cast<int>(height * scale),
-			ColorFromNormalized({ color.r, color.g, color.b, color.a })
-		);
-	}
+	bool parse_config(std::string_view text, Config& obj) {
+		// Every entity takes a line, so the line count bounds the entity count
+		// and the text length bounds the length of the names
+		const auto line_count = static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n')) + 1;
+		obj.entity_templates.reserve(obj.entity_templates.size() + line_count, text.size());
 
-	Entity::Entity(const Entity& other) :
-		name(other.name),
-		position(other.position),
-		velocity(other.velocity),
-		shape(other.shape->clone()),
-		color(other.color),
-		is_active(other.is_active) {
+		auto cursor = ConfigCursor{ text.data(), text.data() + text.size() };
+		auto keyword = std::string_view{};
+		while( cursor.read(keyword) ) {
+			auto parsed = true;
+			if( keyword == "Window" ) {
+				auto caption = std::string_view{};
+				parsed = cursor.read(caption);
+				if( parsed ) {
+					obj.window.caption = caption;
+					parsed = cursor.read_all(obj.window.width, obj.window.height);
+				}
+			}
+			else if( keyword == "World" ) {
+				parsed = cursor.read_all(obj.world.width, obj.world.height);
+				obj.has_world = true;
+			}
+			else if( keyword == "Font" ) {
+				parsed = cursor.read_all(obj.font_asset.file, obj.font_asset.size, obj.font_asset.color.r, obj.font_asset.color.g, obj.font_asset.color.b);
+				obj.font_asset.color.a = 1.0f;
+			}
+			else if( keyword == "Circle" ) {
+				auto name = std::string_view{};
+				auto position = Position{};
+				auto velocity = Velocity{};
+				auto color = Color{};
+				float radius;
+				parsed = read_entity(cursor, name, position, velocity, color, radius);
+				if( parsed ) {
+					obj.entity_templates.add(name, position, velocity, Circle{ radius }, 1.0f, color, true);
+				}
+			}
+			else if( keyword == "Rectangle" ) {
+				auto name = std::string_view{};
+				auto position = Position{};
+				auto velocity = Velocity{};
+				auto color = Color{};
+				float width, height;
+				parsed = read_entity(cursor, name, position, velocity, color, width, height);
+				if( parsed ) {
+					obj.entity_templates.add(name, position, velocity, Rectangle{ width, height }, 1.0f, color, true);
+				}
+			}
+			if( !parsed ) {
+				if( !cursor.exhausted ) {
+					return false;
+				}
+				break;
+			}
+		}
+		if( !obj.has_world ) {
+			obj.world ={ obj.window.width, obj.window.height };
+		}
+		return true;
 	}
 
-	Entity::Entity(Entity&& other) noexcept :
-		name(std::move(other.name)),
-		position(other.position),
-		velocity(other.velocity),
-		shape(std::move(other.shape)),
-		color(other.color),
-		is_active(other.is_active) {
+	bool parse_config_header(std::string_view text, Config& obj) {
+		auto header = std::string{};
+		while( !text.empty() ) {
+			const auto end = std::min(text.find('\n'), text.size());
+			const auto line = text.substr(0, end);
+			auto cursor = ConfigCursor{ line.data(), line.data() + line.size() };
+			auto keyword = std::string_view{};
+			if( cursor.read(keyword) && (keyword == "Window" || keyword == "World" || keyword == "Font") ) {
+				header.append(line);
+				header.push_back('\n');
+			}
+			text.remove_prefix(std::min(end + 1, text.size()));
+		}
+		return parse_config(header, obj);
 	}
 
-	Entity& Entity::operator =(const Entity& right) {
-		if( &right != this ) {
-			name = right.name;
-			position = right.position;
-			velocity = right.velocity;
-			shape = std::unique_ptr<Shape>{ right.shape->clone() };
-			color = right.color;
-			is_active = right.is_active;
+	bool reload_config(std::string_view previous, std::string_view current, Config& config, EntityStore& entities, ConfigChanges& changes) {
+		const auto for_each_line = [](std::string_view text, auto&& visit) {
+			while( !text.empty() ) {
+				const auto end = std::min(text.find('\n'), text.size());
+				const auto line = text.substr(0, end);
+				if( line.find_first_not_of(" \t\r") != std::string_view::npos ) {
+					visit(line);
+				}
+				text.remove_prefix(std::min(end + 1, text.size()));
+			}
+		};
+		const auto keyword = [](std::string_view line) {
+			auto cursor = ConfigCursor{ line.data(), line.data() + line.size() };
+			auto token = std::string_view{};
+			cursor.read(token);
+			return token;
+		};
+
+		// Edits usually touch a few lines, so the leading and trailing lines the
+		// texts share are skipped before the rest is diffed
+		// Comparing blocks with memcmp is several times faster than std::mismatch
+		constexpr std::size_t block_size = 4096;
+		const auto common_prefix_length = [](std::string_view a, std::string_view b) {
+			const auto size = std::min(a.size(), b.size());
+			auto length = std::size_t{ 0 };
+			while( length + block_size <= size && std::memcmp(a.data() + length, b.data() + length, block_size) == 0 ) {
+				length += block_size;
+			}
+			while( length < size && a[length] == b[length] ) {
+				++length;
+			}
+			return length;
+		};
+		const auto common_suffix_length = [](std::string_view a, std::string_view b) {
+			const auto size = std::min(a.size(), b.size());
+			auto length = std::size_t{ 0 };
+			while( length + block_size <= size && std::memcmp(a.data() + a.size() - length - block_size, b.data() + b.size() - length - block_size, block_size) == 0 ) {
+				length += block_size;
+			}
+			while( length < size && a[a.size() - length - 1] == b[b.size() - length - 1] ) {
+				++length;
+			}
+			return length;
+		};
+		const auto common_prefix = common_prefix_length(previous, current);
+		const auto prefix_newline = previous.substr(0, common_prefix).rfind('\n');
+		const auto prefix = prefix_newline == std::string_view::npos ? 0 : prefix_newline + 1;
+		previous.remove_prefix(prefix);
+		current.remove_prefix(prefix);
+		const auto common_suffix = common_suffix_length(previous, current);
+		auto suffix_start = previous.size() - common_suffix;
+		if( suffix_start != 0 && previous[suffix_start - 1] != '\n' ) {
+			const auto newline = previous.find('\n', suffix_start);
+			suffix_start = newline == std::string_view::npos ? previous.size() : newline + 1;
 		}
-		return *this;
-	}
+		current.remove_suffix(previous.size() - suffix_start);
+		previous.remove_suffix(previous.size() - suffix_start);
 
-	Entity& Entity::operator =(Entity&& right) noexcept {
-		if( &right != this ) {
-			name = std::move(right.name);
-			position = right.position;
-			velocity = right.velocity;
-			shape = std::move(right.shape);
-			color = right.color;
-			is_active = right.is_active;
+		// Lines are counted so that repeated lines pair up one to one
+		auto previous_lines = std::unordered_map<std::string_view, std::size_t>{};
+		for_each_line(previous, [&](std::string_view line) { ++previous_lines[line]; });
+		auto added_text = std::string{};
+		auto world_added = false;
+		for_each_line(current, [&](std::string_view line) {
+			if( const auto found = previous_lines.find(line); found != previous_lines.end() && found->second > 0 ) {
+				--found->second;
+				return;
+			}
+			const auto token = keyword(line);
+			changes.window |= token == "Window";
+			changes.font |= token == "Font";
+			world_added |= token == "World";
+			added_text.append(line);
+			added_text.push_back('\n');
+		});
+		auto parsed = Config{};
+		if( !parse_config(added_text, parsed) ) {
+			return false;
 		}
-		return *this;
-	}
 
-	std::istream& operator >>(std::istream& input, Config& obj) {
-		std::string s;
-		while( input >> s ) {
-			if( s == "Window" ) {
-				input
-					>> obj.window.caption
-					>> obj.window.width
-					>> obj.window.height;
-			}
-			else if( s == "Font" ) {
-				input
-					>> obj.font_asset.file
-					>> obj.font_asset.size
-					>> obj.font_asset.color.r >> obj.font_asset.color.g >> obj.font_asset.color.b;
-				obj.font_asset.color.a = 1.0f;
+		auto& templates = config.entity_templates;
+		// Entity index of the first entity with each name ID
+		const auto index_names = [](const EntityStore& store) {
+			auto first = std::vector<std::uint32_t>(store.name_table.size(), std::numeric_limits<std::uint32_t>::max());
+			for( std::size_t i = store.size(); i-- > 0; ) {
+				if( store.is_alive(i) ) {
+					first[store.names[i]] = static_cast<std::uint32_t>(i);
+				}
+			}
+			return first;
+		};
+		const auto find = [](const EntityStore& store, const std::vector<std::uint32_t>& first, std::string_view name) {
+			const auto id = store.name_table.find(name);
+			return id == NameTable::no_name || id >= first.size() ? std::numeric_limits<std::uint32_t>::max() : first[id];
+		};
+		const auto template_index = index_names(templates);
+		const auto entity_index = index_names(entities);
+		for( std::size_t k = 0; k < parsed.entity_templates.size(); ++k ) {
+			const auto& source = parsed.entity_templates;
+			const auto name = source.name_table.view(source.names[k]);
+			const auto position = Position{ source.position_x[k], source.position_y[k] };
+			const auto velocity = Velocity{ source.velocity_x[k], source.velocity_y[k] };
+			const auto& color = source.colors[k];
+			const auto shape = source.shape_types[k] == ShapeType::circle
+				? Shape{ Circle{ source.extent_x[k] } }
+				: Shape{ Rectangle{ 2 * source.extent_x[k], 2 * source.extent_y[k] } };
+			const auto t = find(templates, template_index, name);
+			const auto e = find(entities, entity_index, name);
+			if( t == std::numeric_limits<std::uint32_t>::max() ) {
+				templates.add(name, position, velocity, shape, 1.0f, color, true);
+				entities.add(name, position, velocity, shape, 1.0f, color, true);
+				++changes.added;
+				continue;
+			}
+			auto changed = false;
+			// A live entity missing from a loaded snapshot is added back with the new values
+			const auto is_live = e != std::numeric_limits<std::uint32_t>::max();
+			if( !is_live ) {
+				entities.add(name, position, velocity, shape, 1.0f, color, true);
+			}
+			if( templates.position_x[t] != position.x || templates.position_y[t] != position.y ) {
+				templates.position_x[t] = templates.previous_x[t] = templates.render_x[t] = position.x;
+				templates.position_y[t] = templates.previous_y[t] = templates.render_y[t] = position.y;
+				if( is_live ) {
+					entities.position_x[e] = entities.previous_x[e] = entities.render_x[e] = position.x;
+					entities.position_y[e] = entities.previous_y[e] = entities.render_y[e] = position.y;
+				}
+				changed = true;
+			}
+			if( templates.velocity_x[t] != velocity.x || templates.velocity_y[t] != velocity.y ) {
+				templates.velocity_x[t] = velocity.x;
+				templates.velocity_y[t] = velocity.y;
+				if( is_live ) {
+					entities.velocity_x[e] = velocity.x;
+					entities.velocity_y[e] = velocity.y;
+				}
+				changed = true;
+			}
+			if( templates.shape_types[t] != source.shape_types[k] || templates.extent_x[t] != source.extent_x[k] || templates.extent_y[t] != source.extent_y[k] ) {
+				templates.reshape({ t }, shape);
+				if( is_live ) {
+					entities.reshape({ e }, shape);
+				}
+				changed = true;
 			}
-			else if( s == "Circle" ) {
-				Entity circle_entity;
-				if( read_circle_entity(input, circle_entity) ) {
-					obj.entity_templates.push_back(std::move(circle_entity));
+			const auto& old_color = templates.colors[t];
+			if( old_color.r != color.r || old_color.g != color.g || old_color.b != color.b || old_color.a != color.a ) {
+				templates.colors[t] = color;
+				if( is_live ) {
+					entities.colors[e] = color;
 				}
+				changed = true;
 			}
-			else if( s == "Rectangle" ) {
-				Entity rectangle_entity;
-				if( read_rectangle_entity(input, rectangle_entity) ) {
-					obj.entity_templates.push_back(std::move(rectangle_entity));
+			if( !templates.is_active[t] ) {
+				// Restored after its line was removed by an earlier reload
+				templates.is_active[t] = 1;
+				if( is_live ) {
+					entities.is_active[e] = 1;
 				}
+				changed = true;
 			}
+			changes.changed += changed || !is_live;
 		}
-		return input;
-	}
 
-	void change_selection(Input& input, const std::vector<Entity>& entities) {
-		if( input.selected_index >= entities.size() ) {
-			return;
+		// Lines left over from the previous text were removed or edited; entities
+		// whose names no longer appear in the new lines were removed
+		auto world_removed = false;
+		for( const auto& [line, count] : previous_lines ) {
+			if( count == 0 ) {
+				continue;
+			}
+			auto cursor = ConfigCursor{ line.data(), line.data() + line.size() };
+			auto token = std::string_view{};
+			auto name = std::string_view{};
+			cursor.read(token);
+			world_removed |= token == "World";
+			if( (token != "Circle" && token != "Rectangle") || !cursor.read(name) || parsed.entity_templates.name_table.find(name) != NameTable::no_name ) {
+				continue;
+			}
+			const auto t = find(templates, template_index, name);
+			if( t != std::numeric_limits<std::uint32_t>::max() && templates.is_active[t] ) {
+				templates.is_active[t] = 0;
+				++changes.removed;
+			}
+			if( const auto e = find(entities, entity_index, name); e != std::numeric_limits<std::uint32_t>::max() ) {
+				entities.is_active[e] = 0;
+			}
 		}
-		const auto& entity = entities[input.selected_index];
-		input.is_active = entity.is_active;
-		input.scale = entity.scale;
-		input.velocity[0] = entity.velocity.x;
-		input.velocity[1] = entity.velocity.y;
-		input.color[0] = entity.color.r;
-		input.color[1] = entity.color.g;
-		input.color[2] = entity.color.b;
-		input.name = entity.name;
-	}
-
-	void draw_name(const Input& input, const Entity& entity, const Font& font) {
-		const auto text_size = MeasureTextEx(font, entity.name.c_str(), input.text_size, 1.0f);
-		DrawTextEx(
-			font,
-			entity.name.c_str(),
-			{ entity.position.x - text_size.x / 2, entity.position.y - text_size.y / 2 },
-			input.text_size,
-			1.0f,
-			ColorFromNormalized({ input.text_color[0], input.text_color[1], input.text_color[2], 1.0f })
-		);
-	}
+		templates.update_active_set();
+		entities.update_active_set();
 
-	void draw_shape(const Entity& entity) {
-		entity.shape->draw(entity.position, entity.scale, entity.color);
+		if( changes.window ) {
+			config.window = parsed.window;
+		}
+		if( changes.font ) {
+			config.font_asset = parsed.font_asset;
+		}
+		if( world_added ) {
+			config.world = parsed.world;
+			config.has_world = true;
+			changes.world = true;
+		}
+		else if( world_removed || (changes.window && !config.has_world) ) {
+			// Without a World line the world follows the window
+			config.world ={ config.window.width, config.window.height };
+			config.has_world = false;
+			changes.world = true;
+		}
+		return true;
 	}
 
-	void handle_all_shape_controls_ui(Input& input) {
-		ImGui::SeparatorText("All Shape Controls");
-		ImGui::Checkbox("Draw Shapes", &input.draw_shapes_enabled);
-		ImGui::SameLine();
-		ImGui::Checkbox("Draw Text", &input.draw_text_enabled);
-		ImGui::SameLine();
-		ImGui::Checkbox("Simulate", &input.simulate_enabled);
+	AABB render_aabb(const EntityStore& entities, std::size_t i) {
+		const auto half_width = entities.extent_x[i] * entities.scales[i];
+		const auto half_height = entities.extent_y[i] * entities.scales[i];
+		return {
+			entities.render_x[i] - half_width,
+			entities.render_y[i] - half_height,
+			2 * half_width,
+			2 * half_height
+		};
 	}
 
-	void handle_input(Input& input, const Input& previous_input, std::vector<Entity>& entities) {
-		if( input.selected_index >= entities.size() ) {
-			return;
+	bool restore_snapshot(std::string_view data, EntityStore& entities) {
+		A1_MEMORY_SCOPE(MemoryTag::entities);
+		static_assert(std::is_trivially_copyable_v<Color> && sizeof(ShapeType) == 1);
+		auto header = SnapshotHeader{};
+		if( data.size() < sizeof(header) ) {
+			return false;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+		const auto count = static_cast<std::size_t>(header.entity_count);
+		const auto name_count = static_cast<std::size_t>(header.name_count);
+		const auto ids_at = sizeof(header) + count * (7 * sizeof(float) + sizeof(Color));
+		const auto offsets_at = ids_at + count * sizeof(NameId);
+		const auto types_at = offsets_at + (name_count + 1) * sizeof(std::uint32_t);
+		const auto generations_at = types_at + 2 * count;
+		const auto names_at = generations_at + count * sizeof(std::uint32_t);
+		if( header.magic != SnapshotHeader{}.magic || header.version != SnapshotHeader{}.version || data.size() != names_at + header.name_bytes ) {
+			return false;
+		}
+
+		// Validate everything before touching the store
+		const auto read_value = [&](std::size_t at, std::size_t i) {
+			std::uint32_t value;
+			std::memcpy(&value, data.data() + at + i * sizeof(value), sizeof(value));
+			return value;
+		};
+		const auto name_offset = [&](std::size_t id) { return read_value(offsets_at, id); };
+		if( name_offset(0) != 0 || name_offset(name_count) != header.name_bytes ) {
+			return false;
+		}
+		for( std::size_t id = 0; id < name_count; ++id ) {
+			if( name_offset(id) > name_offset(id + 1) ) {
+				return false;
+			}
+		}
+		for( std::size_t i = 0; i < count; ++i ) {
+			if( read_value(ids_at, i) >= name_count || static_cast<std::uint8_t>(data[types_at + i]) >= shape_type_count ) {
+				return false;
+			}
+			// Active flags become lane masks and active set counts, so must be 0 or 1
+			const auto is_active = static_cast<std::uint8_t>(data[types_at + count + i]);
+			if( is_active > 1 ) {
+				return false;
+			}
+			// Despawned slots are never active
+			if( (read_value(generations_at, i) & 1) != 0 && is_active != 0 ) {
+				return false;
+			}
+		}
+
+		const auto* cursor = data.data() + sizeof(header);
+		const auto read_section = [&](auto& component) {
+			const auto bytes = count * sizeof(component[0]);
+			component.resize(count);
+			std::memcpy(component.data(), cursor, bytes);
+			cursor += bytes;
+		};
+		read_section(entities.position_x);
+		read_section(entities.position_y);
+		read_section(entities.velocity_x);
+		read_section(entities.velocity_y);
+		read_section(entities.scales);
+		read_section(entities.extent_x);
+		read_section(entities.extent_y);
+		read_section(entities.colors);
+		read_section(entities.names);
+		cursor = data.data() + types_at;
+		read_section(entities.shape_types);
+		read_section(entities.is_active);
+		read_section(entities.generations);
+
+		entities.previous_x = entities.position_x;
+		entities.previous_y = entities.position_y;
+		entities.render_x = entities.position_x;
+		entities.render_y = entities.position_y;
+		for( auto& group : entities.shape_groups ) {
+			group.clear();
+		}
+		for( auto& slots : entities.free_slots ) {
+			slots.clear();
+		}
+		for( std::size_t i = 0; i < count; ++i ) {
+			const auto type = static_cast<std::size_t>(entities.shape_types[i]);
+			entities.shape_groups[type].push_back(static_cast<std::uint32_t>(i));
+			if( !entities.is_alive(i) ) {
+				entities.free_slots[type].push_back(static_cast<std::uint32_t>(i));
+			}
+		}
+
+		// A live table that starts with the snapshot's names (the usual reset,
+		// where renames only appended) is cut back and keeps its measurements
+		const auto* names = data.data() + names_at;
+		const auto snapshot_name = [&](std::size_t id) {
+			return std::string_view{ names + name_offset(id), name_offset(id + 1) - name_offset(id) };
+		};
+		auto& table = entities.name_table;
+		auto is_prefix = table.size() >= name_count;
+		for( std::size_t id = 0; is_prefix && id < name_count; ++id ) {
+			is_prefix = table.view(static_cast<NameId>(id)) == snapshot_name(id);
 		}
-		if( input.selected_index == previous_input.selected_index ) {
-			update_selection(input, previous_input, entities);
+		if( is_prefix ) {
+			table.truncate(name_count);
+			std::erase_if(entities.stale_names, [name_count](NameId id) { return id >= name_count; });
 		}
 		else {
-			change_selection(input, entities);
+			table.clear();
+			entities.stale_names.clear();
+			for( std::size_t id = 0; id < name_count; ++id ) {
+				table.append_unindexed(snapshot_name(id));
+				entities.stale_names.push_back(static_cast<NameId>(id));
+			}
+			table.reindex();
 		}
+		entities.name_width.resize(name_count);
+		entities.name_height.resize(name_count);
+		entities.update_active_set();
+		return true;
 	}
 
-	void handle_rendering(const Input& input, const Font& font, const FontAsset& font_asset, const std::vector<Entity>& entities) {
-		for( const auto& entity : entities ) {
-			if( !entity.is_active ) {
-				continue;
+	BenchmarkResult run_benchmark(const BenchmarkOptions& options, const World& world, EntityStore& entities, const Font& font, ShapeRenderer& shape_renderer, TextRenderer& text_renderer, const RenderTexture2D& target, SessionPlayer* replay) {
+		using Clock = std::chrono::steady_clock;
+		const auto milliseconds = [](Clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		};
+		const auto view = AABB{ 0.0f, 0.0f, static_cast<float>(target.texture.width), static_cast<float>(target.texture.height) };
+		const auto percentile = [](std::vector<double> samples, double fraction) {
+			std::sort(samples.begin(), samples.end());
+			return samples[std::min(samples.size() - 1, static_cast<std::size_t>(samples.size() * fraction))];
+		};
+
+		// The benchmark measures the CPU paths, so the compute shader is never loaded
+		const auto gpu_simulation = GpuSimulation{};
+		auto input = Input{};
+		input.parallel_enabled = options.parallel;
+		input.collide_enabled = options.collide;
+		input.motion = options.motion;
+		input.thread_count = options.thread_count;
+		input.text_size = 18.0f;
+		if( replay != nullptr ) {
+			replay->restart(entities);
+		}
+		auto clock = SimulationClock{};
+		auto collision_grid = CollisionGrid{};
+		// One tick per frame, so every frame does the same amount of work
+		auto frame_time = 1.0f / input.tick_rate;
+
+		auto simulation_times = std::vector<double>{};
+		auto render_times = std::vector<double>{};
+		simulation_times.reserve(options.frames);
+		render_times.reserve(options.frames);
+		auto allocations_before = count_allocations();
+		for( std::size_t frame = 0; frame < options.warmup_frames + options.frames; ++frame ) {
+			if( frame == options.warmup_frames ) {
+				allocations_before = count_allocations();
 			}
-			if( input.draw_shapes_enabled ) {
-				draw_shape(entity);
+			const auto simulation_start = Clock::now();
+			if( replay != nullptr ) {
+				replay->apply(input, entities);
+				handle_input(input, entities);
+				frame_time = 1.0f / std::max(input.tick_rate, 1.0f);
 			}
-			if( input.draw_text_enabled ) {
-				draw_name(input, entity, font);
+			handle_simulation(input, world, entities, clock, collision_grid, frame_time);
+			const auto simulation_end = Clock::now();
+			if( options.render ) {
+				measure_names(entities, font, input.text_size);
+				BeginTextureMode(target);
+				ClearBackground(::Color{ 0, 0, 0, 255 });
+				handle_rendering(input, font, {}, entities, shape_renderer, text_renderer, gpu_simulation, view);
+				EndTextureMode();
+			}
+			const auto render_end = Clock::now();
+			if( frame >= options.warmup_frames ) {
+				simulation_times.push_back(milliseconds(simulation_end - simulation_start));
+				render_times.push_back(milliseconds(render_end - simulation_end));
 			}
 		}
-	}
+		const auto allocations_after = count_allocations();
 
-	void handle_reset_ui(Input& input, const std::vector<Entity>& entity_templates, std::vector<Entity>& entities, const FontAsset& font_asset) {
-		ImGui::SeparatorText("");
-		if( ImGui::Button("Reset") ) {
-			entities.clear();
-			std::copy(entity_templates.begin(), entity_templates.end(), std::back_inserter(entities));
-			input.draw_shapes_enabled = true;
-			input.draw_text_enabled = true;
-			input.simulate_enabled = true;
-			input.selected_index = 0;
-			initialize_ui(input, entities, font_asset);
+		auto result = BenchmarkResult{};
+		result.entities = entities.size();
+		result.frames = options.frames;
+		auto total_ms = 0.0;
+		for( const auto time : simulation_times ) {
+			total_ms += time;
 		}
+		result.simulation_ns_per_entity = entities.size() == 0 ? 0.0 : total_ms * 1e6 / (static_cast<double>(options.frames) * entities.size());
+		result.simulation_p50_ms = percentile(simulation_times, 0.50);
+		result.simulation_p99_ms = percentile(simulation_times, 0.99);
+		if( options.render ) {
+			result.render_p50_ms = percentile(render_times, 0.50);
+			result.render_p99_ms = percentile(render_times, 0.99);
+		}
+		result.allocations_per_frame = static_cast<double>(allocations_after - allocations_before) / options.frames;
+		return result;
 	}
 
-	void handle_selected_shape_ui(Input& input, std::vector<Entity>& entities) {
-		ImGui::SeparatorText("Selected Shape Controls");
-		if( entities.size() == 0 ) {
-			return;
+	int run_benchmarks(int argc, char* argv[]) {
+		auto options = BenchmarkOptions{};
+		if( !parse_benchmark_options(argc, argv, options) ) {
+			std::cerr
+				<< "Usage: " << argv[0] << " [--entities N,N,...] [--config File] [--frames N] [--warmup N]\n"
+				<< "       [--render] [--parallel] [--collide] [--wrap] [--gravity N] [--damping N]\n"
+				<< "       [--threads N] [--seed N] [--json]\n"
+				<< "       [--replay File]  replays a recorded session with its own settings\n";
+			return 1;
 		}
-		if( ImGui::BeginCombo("Shape", entities[input.selected_index].name.c_str()) ) {
-			for( std::size_t i = 0; i < entities.size(); ++i ) {
-				const bool is_selected = input.selected_index == i;
-				if( ImGui::Selectable(entities[i].name.c_str(), is_selected) ) {
-					input.selected_index = i;
-				}
-				if( is_selected ) {
-					ImGui::SetItemDefaultFocus();
-				}
+
+		auto config = Config{};
+		if( !options.config_path.empty() ) {
+			try {
+				config = load_config(options.config_path);
+			}
+			catch( const std::runtime_error& error ) {
+				std::cerr << error.what() << '\n';
+				return 1;
 			}
-			ImGui::EndCombo();
 		}
-		ImGui::Checkbox("Active", &input.is_active);
-		ImGui::SliderFloat("Scale", &input.scale, 0.1f, 5.0f);
-		ImGui::SliderFloat2("Velocity", input.velocity, -75.0f, 75.0f);
-		ImGui::ColorEdit3("Color", input.color);
-		ImGui::InputText("Name", &input.name);
-	}
+		auto replay = SessionPlayer{};
+		if( !options.replay_path.empty() ) {
+			if( !replay.load(options.replay_path) || replay.frame_count() == 0 ) {
+				std::cerr << "Failed to read session file.\n";
+				return 1;
+			}
+			config.world = replay.world();
+		}
+		const auto& window = config.window;
+		const auto& world = config.world;
 
-	void handle_simulation(const Input& input, const Window& window, std::vector<Entity>& entities) {
-		for( auto& entity : entities ) {
-			if( !entity.is_active ) {
-				continue;
+		auto font = Font{};
+		auto shape_renderer = ShapeRenderer{};
+		auto text_renderer = TextRenderer{};
+		auto target = RenderTexture2D{};
+		if( options.render ) {
+			// Rendering needs a GL context, which raylib only creates with a window
+#if defined(__linux__)
+			// raylib crashes inside InitWindow when there is no display to connect to
+			if( std::getenv("DISPLAY") == nullptr && std::getenv("WAYLAND_DISPLAY") == nullptr ) {
+				std::cerr << "--render needs a display (set DISPLAY, e.g. under xvfb-run).\n";
+				return 1;
+			}
+#endif
+			SetConfigFlags(FLAG_WINDOW_HIDDEN);
+			SetTraceLogLevel(LOG_WARNING);
+			InitWindow(window.width, window.height, "a1 benchmark");
+			if( !IsWindowReady() ) {
+				std::cerr << "Failed to create a GL context for --render.\n";
+				return 1;
 			}
-			if( input.simulate_enabled ) {
-				move(entity, window);
+			shape_renderer.load("assets/shaders/shapes.vs", "assets/shaders/shapes.fs");
+			if( !config.font_asset.file.empty() ) {
+				text_renderer.load(config.font_asset.file, "assets/shaders/text.vs", "assets/shaders/text.fs");
 			}
+			font = text_renderer.is_ready() ? text_renderer.font()
+				: config.font_asset.file.empty() ? GetFontDefault() : LoadFont(config.font_asset.file.string().c_str());
+			target = LoadRenderTexture(window.width, window.height);
 		}
-	}
 
-	void handle_text_ui(Input& input) {
-		ImGui::SeparatorText("Text Controls");
-		ImGui::SliderFloat("Size##Text", &input.text_size, 8.0f, 72.0f);
-		ImGui::ColorEdit3("Color##Text", input.text_color);
+		auto results = std::vector<BenchmarkResult>{};
+		auto entities = EntityStore{};
+		if( !options.replay_path.empty() ) {
+			// Every recorded frame is replayed and measured, and nothing else
+			auto replay_options = options;
+			replay_options.frames = replay.frame_count();
+			replay_options.warmup_frames = 0;
+			results.push_back(run_benchmark(replay_options, world, entities, font, shape_renderer, text_renderer, target, &replay));
+		}
+		else if( !options.config_path.empty() ) {
+			entities = config.entity_templates;
+			results.push_back(run_benchmark(options, world, entities, font, shape_renderer, text_renderer, target, nullptr));
+		}
+		else {
+			for( const auto count : options.entity_counts ) {
+				auto generator = GeneratorSettings{};
+				generator.count = static_cast<int>(count);
+				generator.seed = options.seed;
+				generate_entities(entities, generator, world, options.thread_count);
+				results.push_back(run_benchmark(options, world, entities, font, shape_renderer, text_renderer, target, nullptr));
+			}
+		}
+		write_benchmark_results(std::cout, results, select_integration_kernel().name, options.json);
+
+		if( options.render ) {
+			UnloadRenderTexture(target);
+			shape_renderer.unload();
+			if( !config.font_asset.file.empty() && !text_renderer.is_ready() ) {
+				UnloadFont(font);
+			}
+			text_renderer.unload();
+			CloseWindow();
+		}
+		return 0;
 	}
 
-	void initialize_ui(Input& input, const std::vector<Entity>& entities, const FontAsset& font_asset) {
-		change_selection(input, entities);
-		input.text_size = font_asset.size;
-		input.text_color[0] = font_asset.color.r;
-		input.text_color[1] = font_asset.color.g;
-		input.text_color[2] = font_asset.color.b;
+	bool save_snapshot(const EntityStore& entities, const std::filesystem::path& path) {
+		auto buffer = std::vector<char>{};
+		write_snapshot(entities, buffer);
+		auto output = std::ofstream{ path, std::ios::binary };
+		output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		return static_cast<bool>(output);
 	}
 
-	Config load_config(const std::filesystem::path& path) {
-		auto input_file = std::ifstream{ path };
-		a1::Config config;
-		input_file >> config;
-		if( !input_file && !input_file.eof() ) {
-			throw std::runtime_error("Failed to read configuration file.");
+	IntegrationKernel select_integration_kernel() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		__builtin_cpu_init();
+		// DQ/BW/VL are needed to move comparison masks back into vector registers
+		// cheaply, without them the AVX-512 kernel is slower than AVX2
+		if( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+			&& __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") ) {
+			return { "AVX-512", 16, make_integration_variants<Avx512Kernel>() };
 		}
-		return config;
+		if( __builtin_cpu_supports("avx2") ) {
+			return { "AVX2", 8, make_integration_variants<Avx2Kernel>() };
+		}
+		if( __builtin_cpu_supports("sse2") ) {
+			return { "SSE2", 4, make_integration_variants<Sse2Kernel>() };
+		}
+#elif defined(__GNUC__) && defined(__ARM_NEON)
+		return { "NEON", 4, make_integration_variants<NeonKernel>() };
+#endif
+		return { "Scalar", 1, make_integration_variants<ScalarKernel>() };
 	}
 
-	void move(Entity& entity, const Window& window) {
-		const auto next_position = Position{
-			entity.position.x + entity.velocity.x,
-			entity.position.y + entity.velocity.y
-		};
-		const auto aabb = entity.shape->aabb(next_position, entity.scale);
-		// If the shape goes outside the screen, adjust velocity in the appropriate
-		// direction
-		if( aabb.x < 0 || aabb.x + aabb.width > window.width ) {
-			entity.velocity.x = -entity.velocity.x;
-		}
-		if( aabb.y < 0 || aabb.y + aabb.height > window.height ) {
-			entity.velocity.y = -entity.velocity.y;
+	void reset_selection(Input& input, const EntityStore& entities) {
+		input.selection.resize(entities.size());
+		input.selection.clear();
+		input.selected = {};
+		for( std::size_t i = 0; i < entities.size(); ++i ) {
+			if( entities.is_alive(i) ) {
+				select_entity(input, entities.handle(i), false);
+				break;
+			}
 		}
-		entity.position ={
-			entity.position.x + entity.velocity.x,
-			entity.position.y + entity.velocity.y
-		};
+		input.filter_dirty = true;
+		input.mark(InputChange::view);
+		input.mark(InputChange::scene);
 	}
 
-	std::istream& read_circle_entity(std::istream& input, Entity& entity) {
-		float radius;
-		if( read_common_components(input, entity) && input >> radius ) {
-			entity.shape = std::make_unique<Circle>(radius);
+	void select_entity(Input& input, EntityHandle handle, bool extend) {
+		if( !extend ) {
+			input.selection.clear();
 		}
-		return input;
+		input.selection.add(handle.index);
+		input.selected = handle;
+		input.mark(InputChange::selection);
 	}
 
-	std::istream& read_common_components(std::istream& input, Entity& entity) {
-		input
-			>> entity.name
-			>> entity.position.x >> entity.position.y
-			>> entity.velocity.x >> entity.velocity.y
-			>> entity.color.r >> entity.color.g >> entity.color.b;
-		entity.color.a = 1.0f;
-		entity.is_active = true;
-		return input;
+	void* tracked_allocate(std::size_t size) {
+		auto* header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+		if( header == nullptr ) {
+			return nullptr;
+		}
+		header->size = size;
+		header->tag = memory_tag;
+		auto& counters = memory_counters[static_cast<std::size_t>(header->tag)];
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+		const auto live_bytes = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+		auto peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+		while( live_bytes > peak_bytes && !counters.peak_bytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed) ) {
+		}
+		return header + 1;
 	}
 
-	std::istream& read_rectangle_entity(std::istream& input, Entity& entity) {
-		float width, height;
-		if( read_common_components(input, entity) && input >> width >> height ) {
-			entity.shape = std::make_unique<Rectangle>(width, height);
+	void tracked_free(void* block) noexcept {
+		if( block == nullptr ) {
+			return;
 		}
-		return input;
+		auto* header = static_cast<AllocationHeader*>(block) - 1;
+		memory_counters[static_cast<std::size_t>(header->tag)].live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+		std::free(header);
 	}
 
-	void update_selection(Input& input, const Input& previous_input, std::vector<Entity>& entities) {
-		auto& entity = entities[input.selected_index];
-		entity.is_active = input.is_active;
-		entity.scale = input.scale;
+	void update_selection(Input& input, EntityStore& entities) {
+		const auto& indices = input.selection.indices;
+		// One pass per edited component keeps each loop streaming a single array
+		if( input.changed(InputChange::is_active) ) {
+			const auto is_active = static_cast<std::uint8_t>(input.is_active);
+			for( const auto i : indices ) {
+				entities.is_active[i] = is_active;
+			}
+			entities.update_active_set();
+		}
+		if( input.changed(InputChange::scale) ) {
+			for( const auto i : indices ) {
+				entities.scales[i] = input.scale;
+			}
+		}
 		// Update entity velocity if the input changed, or else update the input field
 		// to show the current velocity
-		if( input.velocity[0] == previous_input.velocity[0] ) {
-			input.velocity[0] = entity.velocity.x;
+		const auto primary = input.selected.index;
+		if( input.changed(InputChange::velocity_x) ) {
+			for( const auto i : indices ) {
+				entities.velocity_x[i] = input.velocity[0];
+			}
+		}
+		else {
+			input.velocity[0] = entities.velocity_x[primary];
+		}
+		if( input.changed(InputChange::velocity_y) ) {
+			for( const auto i : indices ) {
+				entities.velocity_y[i] = input.velocity[1];
+			}
 		}
 		else {
-			entity.velocity.x = input.velocity[0];
+			input.velocity[1] = entities.velocity_y[primary];
+		}
+		if( input.changed(InputChange::color) ) {
+			const auto color = Color{ input.color[0], input.color[1], input.color[2] };
+			for( const auto i : indices ) {
+				entities.colors[i] = color;
+			}
+		}
+		if( input.changed(InputChange::name) ) {
+			entities.rename(input.selected, input.name);
 		}
-		if( input.velocity[1] == previous_input.velocity[1] ) {
-			input.velocity[1] = entity.velocity.y;
+	}
+
+	AABB view_bounds(const Camera2D& camera, float width, float height) {
+		const auto top_left = GetScreenToWorld2D({ 0.0f, 0.0f }, camera);
+		return { top_left.x, top_left.y, width / camera.zoom, height / camera.zoom };
+	}
+
+	void write_benchmark_results(std::ostream& output, const std::vector<BenchmarkResult>& results, std::string_view kernel, bool json) {
+		if( json ) {
+			output << "[\n";
+			for( std::size_t i = 0; i < results.size(); ++i ) {
+				const auto& result = results[i];
+				output
+					<< "  { \"entities\": " << result.entities
+					<< ", \"frames\": " << result.frames
+					<< ", \"kernel\": \"" << kernel << '"'
+					<< ", \"simulation_ns_per_entity\": " << result.simulation_ns_per_entity
+					<< ", \"simulation_p50_ms\": " << result.simulation_p50_ms
+					<< ", \"simulation_p99_ms\": " << result.simulation_p99_ms
+					<< ", \"render_p50_ms\": " << result.render_p50_ms
+					<< ", \"render_p99_ms\": " << result.render_p99_ms
+					<< ", \"allocations_per_frame\": " << result.allocations_per_frame
+					<< " }" << (i + 1 < results.size() ? ",\n" : "\n");
+			}
+			output << "]\n";
 		}
 		else {
-			entity.velocity.y = input.velocity[1];
+			output << "entities,frames,kernel,simulation_ns_per_entity,simulation_p50_ms,simulation_p99_ms,render_p50_ms,render_p99_ms,allocations_per_frame\n";
+			for( const auto& result : results ) {
+				output
+					<< result.entities << ','
+					<< result.frames << ','
+					<< kernel << ','
+					<< result.simulation_ns_per_entity << ','
+					<< result.simulation_p50_ms << ','
+					<< result.simulation_p99_ms << ','
+					<< result.render_p50_ms << ','
+					<< result.render_p99_ms << ','
+					<< result.allocations_per_frame << '\n';
+			}
 		}
-		entity.color ={ input.color[0], input.color[1], input.color[2] };
-		entity.name = input.name;
 	}
-}
\ No newline at end of file
+
+	void write_snapshot(const EntityStore& entities, std::vector<char>& buffer) {
+		const auto count = entities.size();
+		const auto& table = entities.name_table;
+		auto header = SnapshotHeader{};
+		header.entity_count = static_cast<std::uint32_t>(count);
+		header.name_count = static_cast<std::uint32_t>(table.size());
+		for( NameId id = 0; id < table.size(); ++id ) {
+			header.name_bytes += static_cast<std::uint32_t>(table.view(id).size());
+		}
+		buffer.clear();
+		const auto append = [&](const void* data, std::size_t bytes) {
+			const auto* first = static_cast<const char*>(data);
+			buffer.insert(buffer.end(), first, first + bytes);
+		};
+		const auto append_section = [&](const auto& component) {
+			append(component.data(), component.size() * sizeof(component[0]));
+		};
+		buffer.reserve(sizeof(header) + count * (7 * sizeof(float) + sizeof(Color) + sizeof(NameId) + 2 + sizeof(std::uint32_t)) + (table.size() + 1) * sizeof(std::uint32_t) + header.name_bytes);
+		append(&header, sizeof(header));
+		append_section(entities.position_x);
+		append_section(entities.position_y);
+		append_section(entities.velocity_x);
+		append_section(entities.velocity_y);
+		append_section(entities.scales);
+		append_section(entities.extent_x);
+		append_section(entities.extent_y);
+		append_section(entities.colors);
+		append_section(entities.names);
+		auto offset = std::uint32_t{ 0 };
+		append(&offset, sizeof(offset));
+		for( NameId id = 0; id < table.size(); ++id ) {
+			offset += static_cast<std::uint32_t>(table.view(id).size());
+			append(&offset, sizeof(offset));
+		}
+		append_section(entities.shape_types);
+		append_section(entities.is_active);
+		append_section(entities.generations);
+		for( NameId id = 0; id < table.size(); ++id ) {
+			const auto name = table.view(id);
+			append(name.data(), name.size());
+		}
+	}
+}